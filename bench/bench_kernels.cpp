@@ -0,0 +1,236 @@
+// Kernel microbenchmarks: times the step kernels, the boundary fill, the halo exchange and the
+// output packing in isolation over a sweep of tile sizes, and relates their memory traffic to a
+// STREAM triad measured on the same ranks and threads.
+//
+//   mpirun -np P bench_kernels [--sizes=64,128,...] [--min_time=0.5] [--stream_mb=128]
+//                              [--threads=N] [--simd=auto] [--out=bench/results/kernels]
+//
+// Every rank owns one tile of each size and all ranks run concurrently, so bandwidths are per
+// rank under a full node's load. Results go to <out>.csv and <out>.json.
+
+#include <mpi.h>
+
+#include <ctime>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "advection.hpp"
+#include "allocator.hpp"
+#include "bench_util.hpp"
+#include "boundary.hpp"
+#include "decomp.hpp"
+#include "diffusion.hpp"
+#include "field.hpp"
+#include "halo.hpp"
+#include "io.hpp"
+#include "simd.hpp"
+#include "threads.hpp"
+#include "tiling.hpp"
+
+#ifndef CLIMATE_SIM_VERSION
+#define CLIMATE_SIM_VERSION "unknown"
+#endif
+
+namespace {
+
+struct Result {
+    std::string kernel;
+    int nx, ny;
+    double cells;    // cells the kernel processes per call
+    double bytes;    // minimum memory (or network) traffic per call
+    double seconds;  // best time per call, max over ranks
+
+    double ns_per_cell() const { return cells > 0 ? seconds / cells * 1e9 : 0.0; }
+    double gbs() const { return seconds > 0 ? bytes / seconds * 1e-9 : 0.0; }
+};
+
+// STREAM triad a = b + s * c over arrays of `mb` MiB each; per-rank GB/s, counting 24 bytes per
+// element as STREAM does (no write-allocate).
+double stream_triad_gbs(int mb, double min_time, MPI_Comm comm) {
+    const size_t n = static_cast<size_t>(mb) * (1u << 20) / sizeof(double);
+    std::vector<double, FieldAllocator<double>> a(n), b(n), c(n);
+    const long len = static_cast<long>(n);
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < len; ++i) {
+        a[i] = 0.0;
+        b[i] = 1.0;
+        c[i] = 2.0;
+    }
+    double* pa = a.data();
+    const double* pb = b.data();
+    const double* pc = c.data();
+    const double s = 3.0;
+    const double t = best_seconds_per_call(
+        [&] {
+#pragma omp parallel for simd schedule(static)
+            for (long i = 0; i < len; ++i) pa[i] = pb[i] + s * pc[i];
+        },
+        min_time, comm);
+    return 3.0 * sizeof(double) * n / t * 1e-9;
+}
+
+// Bytes this rank sends plus receives in one single-layer exchange.
+double halo_bytes(const Decomp2D& dec) {
+    double cells = 0.0;
+    for (int s = 0; s < 2; ++s) {
+        cells += dec.nbr_lr[s] != MPI_PROC_NULL ? dec.ny_local : 0;
+        cells += dec.nbr_du[s] != MPI_PROC_NULL ? dec.nx_local : 0;
+    }
+    return 2.0 * cells * sizeof(double);
+}
+
+std::vector<Result> bench_size(int n, double min_time, MPI_Comm comm) {
+    std::vector<Result> out;
+    const double D = 0.1, vx = 0.3, vy = -0.2, dt = 0.5;
+    const double cells = static_cast<double>(n) * n;
+    const double stencil_bytes = 2.0 * sizeof(double) * cells;  // read u, write out
+
+    Field u(n, n, 1, 1.0, 1.0), tmp(n, n, 1, 1.0, 1.0);
+    u.fill(1.0);
+    tmp.fill(0.0);
+    set_tile_shape(resolve_tile_shape(0, 0, n, n, sizeof(double)));
+
+    out.push_back({"diffusion_step", n, n, cells, stencil_bytes,
+                   best_seconds_per_call([&] { diffusion_step(u, tmp, D, dt); }, min_time, comm)});
+    out.push_back(
+        {"advection_step", n, n, cells, stencil_bytes,
+         best_seconds_per_call([&] { advection_step(u, tmp, vx, vy, dt); }, min_time, comm)});
+
+    // Boundary fill on a tile whose four sides are all physical.
+    {
+        Decomp2D self;
+        self.init(MPI_COMM_SELF, n, n);
+        BCConfig bc;
+        bc.left = bc.bottom = BCType::Neumann;
+        const double ghosts = 4.0 * n;
+        out.push_back({"apply_boundary", n, n, ghosts, 2.0 * sizeof(double) * ghosts,
+                       best_seconds_per_call([&] { apply_boundary(u, self, bc, 0.0); },
+                                             min_time, comm)});
+        self.finalize();
+    }
+
+    // Halo exchange with the neighbors of a P-rank grid of n x n tiles.
+    {
+        int size = 1;
+        MPI_Comm_size(comm, &size);
+        int dims[2] = {0, 0};
+        MPI_Dims_create(size, 2, dims);
+        Decomp2D dec;
+        dec.init(comm, n * dims[0], n * dims[1]);
+        const double bytes = halo_bytes(dec);
+        const double ghosts = bytes / (2.0 * sizeof(double));
+        out.push_back({"exchange_halos", n, n, ghosts, bytes,
+                       best_seconds_per_call([&] { exchange_halos(u, dec, comm); },
+                                             min_time, comm)});
+        HaloPlan plan(u, dec, comm);
+        out.push_back({"halo_plan", n, n, ghosts, bytes,
+                       best_seconds_per_call([&] { plan.exchange(u); }, min_time, comm)});
+        dec.finalize();
+    }
+
+    std::vector<double> buf(static_cast<size_t>(n) * n);
+    out.push_back({"pack_interior", n, n, cells, stencil_bytes,
+                   best_seconds_per_call([&] { pack_interior(u, 0, buf.data()); }, min_time,
+                                         comm)});
+    return out;
+}
+
+std::string timestamp() {
+    const std::time_t now = std::time(nullptr);
+    char s[32];
+    std::strftime(s, sizeof(s), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    return s;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int thread_level = MPI_THREAD_SINGLE;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_level);
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    int rc = 0;
+    try {
+        const BenchArgs args(argc, argv);
+        const std::vector<int> sizes =
+            args.int_list("sizes", {64, 128, 256, 512, 1024, 2048});
+        const double min_time = args.real("min_time", 0.5);
+        const std::string out = args.str("out", "bench/results/kernels");
+        set_threads(args.integer("threads", 0));
+        set_simd_level(resolve_simd_level(args.str("simd", "auto")));
+
+        const double stream = stream_triad_gbs(args.integer("stream_mb", 128), min_time,
+                                               MPI_COMM_WORLD);
+        if (rank == 0) {
+            std::cout << std::setprecision(4) << "bench_kernels: " << size << " ranks x "
+                      << max_threads() << " threads, simd " << simd_to_string(active_simd_level())
+                      << ", STREAM triad " << stream << " GB/s per rank\n"
+                      << std::left << std::setw(16) << "kernel" << std::right << std::setw(8)
+                      << "tile" << std::setw(14) << "ns/cell" << std::setw(12) << "GB/s"
+                      << std::setw(10) << "%STREAM" << "\n";
+        }
+
+        std::vector<Result> results;
+        for (int n : sizes) {
+            for (const Result& r : bench_size(n, min_time, MPI_COMM_WORLD)) {
+                results.push_back(r);
+                if (rank == 0)
+                    std::cout << std::left << std::setw(16) << r.kernel << std::right
+                              << std::setw(8) << r.nx << std::setw(14) << r.ns_per_cell()
+                              << std::setw(12) << r.gbs() << std::setw(10)
+                              << 100.0 * r.gbs() / stream << "\n";
+            }
+        }
+
+        if (rank == 0) {
+            const std::filesystem::path dir = std::filesystem::path(out).parent_path();
+            if (!dir.empty())
+                std::filesystem::create_directories(dir);
+            std::ofstream csv(out + ".csv"), json(out + ".json");
+            if (!csv || !json)
+                throw std::runtime_error("cannot write " + out + ".csv/.json");
+
+            const std::string date = timestamp();
+            csv << "# version=" << CLIMATE_SIM_VERSION << " date=" << date
+                << " ranks=" << size << " threads=" << max_threads()
+                << " simd=" << simd_to_string(active_simd_level()) << " stream_gbs=" << stream
+                << "\n"
+                << "kernel,nx,ny,cells,bytes,seconds,ns_per_cell,gbs,pct_stream\n";
+            json << "{\n  \"version\": \"" << CLIMATE_SIM_VERSION << "\",\n  \"date\": \""
+                 << date << "\",\n  \"ranks\": " << size
+                 << ",\n  \"threads\": " << max_threads() << ",\n  \"simd\": \""
+                 << simd_to_string(active_simd_level()) << "\",\n  \"stream_gbs\": " << stream
+                 << ",\n  \"results\": [";
+            for (size_t i = 0; i < results.size(); ++i) {
+                const Result& r = results[i];
+                const double gbs = r.gbs(), ns = r.ns_per_cell();
+                const double pct = 100.0 * gbs / stream;
+                csv << r.kernel << "," << r.nx << "," << r.ny << "," << r.cells << ","
+                    << r.bytes << "," << r.seconds << "," << ns << "," << gbs << "," << pct
+                    << "\n";
+                json << (i ? ",\n" : "\n") << "    {\"kernel\": \"" << r.kernel
+                     << "\", \"nx\": " << r.nx << ", \"ny\": " << r.ny
+                     << ", \"cells\": " << r.cells << ", \"bytes\": " << r.bytes
+                     << ", \"seconds\": " << r.seconds << ", \"ns_per_cell\": " << ns
+                     << ", \"gbs\": " << gbs << ", \"pct_stream\": " << pct << "}";
+            }
+            json << "\n  ]\n}\n";
+            std::cout << "results: " << out << ".csv, " << out << ".json\n";
+        }
+    } catch (const std::exception& e) {
+        if (rank == 0)
+            std::cerr << "bench_kernels: " << e.what() << "\n";
+        rc = 1;
+    }
+
+    MPI_Finalize();
+    return rc;
+}
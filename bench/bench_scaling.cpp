@@ -0,0 +1,268 @@
+// Strong and weak scaling in one launch: started on P ranks, the driver splits MPI_COMM_WORLD into
+// sub-communicators of 1, 2, 4, ... ranks (up to P) and times the step loop on each, with output
+// disabled. Ranks outside the active sub-communicator wait in a barrier, so give every rank its
+// own core.
+//
+//   mpirun -np P bench_scaling [--ranks=1,2,4,...] [--strong.nx=1024] [--strong.ny=1024]
+//                              [--weak.nx=256] [--weak.ny=256] [--steps=200] [--warmup=10]
+//                              [--out=bench/results/scaling] [climate_sim flags...]
+//
+// Physics and perf settings come from `--config` and the usual climate_sim flags. Results go to
+// <out>.csv and <out>.json.
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "decomp.hpp"
+#include "field.hpp"
+#include "init.hpp"
+#include "io.hpp"
+#include "simd.hpp"
+#include "stepper.hpp"
+#include "threads.hpp"
+#include "tiling.hpp"
+#include "timestep.hpp"
+
+#ifndef CLIMATE_SIM_VERSION
+#define CLIMATE_SIM_VERSION "unknown"
+#endif
+
+namespace {
+
+struct Run {
+    std::string mode;  // "strong" or "weak"
+    int ranks = 1;
+    int px = 1, py = 1;
+    int nx = 0, ny = 0;
+    double seconds = 0.0;  // step loop, max over the sub-communicator's ranks
+};
+
+// Derived metrics of `r` against the single-rank run `base` of the same mode. Weak scaling uses
+// the scaled speedup p * T1 / Tp. Karp-Flatt e = (1/S - 1/p) / (1 - 1/p) is the experimentally
+// determined serial fraction; undefined for p = 1.
+struct Metrics {
+    double speedup, efficiency;
+    std::optional<double> karp_flatt;
+};
+
+Metrics metrics(const Run& r, const Run& base) {
+    const double p = r.ranks;
+    const double ratio = base.seconds / r.seconds;
+    Metrics m;
+    m.speedup = r.mode == "weak" ? p * ratio : ratio;
+    m.efficiency = m.speedup / p;
+    if (r.ranks > 1)
+        m.karp_flatt = (1.0 / m.speedup - 1.0 / p) / (1.0 - 1.0 / p);
+    return m;
+}
+
+// Times `steps` steps after `warmup` untimed ones on the ranks of `comm`.
+template <typename T, typename Acc>
+double time_steps(const SimConfig& cfg, const Decomp2D& dec, MPI_Comm comm, int warmup) {
+    BasicStepper<T, Acc> stepper(cfg, dec, comm);
+    FieldT<T> u(dec.nx_local, dec.ny_local, stepper.halo(), cfg.dx, cfg.dy, cfg.tracers);
+    FieldT<T> tmp(dec.nx_local, dec.ny_local, stepper.halo(), cfg.dx, cfg.dy, cfg.tracers);
+    u.fill(T(0));
+    tmp.fill(T(0));
+    apply_initial_condition(dec, u, cfg);
+
+    for (int n = 0; n < warmup; ++n) stepper.step(u, tmp);
+    MPI_Barrier(comm);
+    const double t0 = MPI_Wtime();
+    for (int n = 0; n < cfg.steps; ++n) stepper.step(u, tmp);
+    double t = MPI_Wtime() - t0;
+    MPI_Allreduce(MPI_IN_PLACE, &t, 1, MPI_DOUBLE, MPI_MAX, comm);
+    return t;
+}
+
+// Runs one configuration on a `comm` of p ranks; returns the timing on every rank of `comm`.
+Run run_on(SimConfig cfg, const std::string& mode, int nx, int ny, MPI_Comm comm, int warmup) {
+    Run r;
+    r.mode = mode;
+    MPI_Comm_size(comm, &r.ranks);
+    cfg.nx = r.nx = nx;
+    cfg.ny = r.ny = ny;
+    cfg.dt = std::min(cfg.dt, local_dt_limit(cfg));
+
+    Decomp2D dec;
+    dec.init(comm, nx, ny);
+    r.px = dec.dims[0];
+    r.py = dec.dims[1];
+    set_tile_shape(resolve_tile_shape(cfg.perf.tile_x,
+                                      cfg.perf.tile_y,
+                                      dec.nx_local,
+                                      dec.ny_local,
+                                      precision_storage_bytes(cfg.precision)));
+    switch (cfg.precision) {
+        case Precision::Double:
+            r.seconds = time_steps<double, double>(cfg, dec, comm, warmup);
+            break;
+        case Precision::Float:
+            r.seconds = time_steps<float, float>(cfg, dec, comm, warmup);
+            break;
+        case Precision::Mixed:
+            r.seconds = time_steps<float, double>(cfg, dec, comm, warmup);
+            break;
+    }
+    dec.finalize();
+    return r;
+}
+
+std::vector<int> default_rank_counts(int world) {
+    std::vector<int> counts;
+    for (int p = 1; p <= world; p *= 2) counts.push_back(p);
+    if (counts.back() != world)
+        counts.push_back(world);
+    return counts;
+}
+
+std::string csv_opt(const std::optional<double>& v) {
+    std::ostringstream os;
+    if (v)
+        os << *v;
+    return os.str();
+}
+
+std::string json_opt(const std::optional<double>& v) {
+    std::ostringstream os;
+    if (v)
+        os << *v;
+    else
+        os << "null";
+    return os.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int thread_level = MPI_THREAD_SINGLE;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_level);
+    int rank = 0, world = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world);
+
+    int rc = 0;
+    try {
+        const BenchArgs args(argc, argv);
+        std::optional<std::string> cfg_path;
+        if (args.has("config"))
+            cfg_path = args.str("config", "");
+        SimConfig cfg = merged_config(cfg_path, std::vector<std::string>(argv + 1, argv + argc));
+        cfg.steps = args.integer("steps", 200);
+        const int warmup = args.integer("warmup", 10);
+        const int strong_nx = args.integer("strong.nx", 1024);
+        const int strong_ny = args.integer("strong.ny", 1024);
+        const int weak_nx = args.integer("weak.nx", 256);
+        const int weak_ny = args.integer("weak.ny", 256);
+        const std::string out = args.str("out", "bench/results/scaling");
+        std::vector<int> counts = args.int_list("ranks", default_rank_counts(world));
+        counts.push_back(1);  // the baseline of every metric
+        std::sort(counts.begin(), counts.end());
+        counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+        for (int p : counts)
+            if (p < 1 || p > world)
+                throw std::runtime_error("--ranks: " + std::to_string(p) + " not in [1, " +
+                                         std::to_string(world) + "]");
+
+        set_simd_level(resolve_simd_level(cfg.perf.simd));
+        set_threads(cfg.perf.threads);
+        set_field_layout(FieldLayout{cfg.perf.pad_rows, cfg.perf.huge_pages});
+
+        std::vector<Run> runs;
+        for (const std::string mode : {"strong", "weak"}) {
+            for (int p : counts) {
+                MPI_Comm sub;
+                MPI_Comm_split(MPI_COMM_WORLD, rank < p ? 0 : MPI_UNDEFINED, rank, &sub);
+                if (sub != MPI_COMM_NULL) {
+                    int dims[2] = {0, 0};
+                    MPI_Dims_create(p, 2, dims);
+                    const bool strong = mode == "strong";
+                    const Run r = run_on(cfg, mode, strong ? strong_nx : weak_nx * dims[0],
+                                         strong ? strong_ny : weak_ny * dims[1], sub, warmup);
+                    if (rank == 0)
+                        runs.push_back(r);
+                    MPI_Comm_free(&sub);
+                }
+                MPI_Barrier(MPI_COMM_WORLD);
+            }
+        }
+
+        if (rank == 0) {
+            const std::filesystem::path dir = std::filesystem::path(out).parent_path();
+            if (!dir.empty())
+                std::filesystem::create_directories(dir);
+            std::ofstream csv(out + ".csv"), json(out + ".json");
+            if (!csv || !json)
+                throw std::runtime_error("cannot write " + out + ".csv/.json");
+
+            csv << "# version=" << CLIMATE_SIM_VERSION << " threads=" << max_threads()
+                << " scheme=" << scheme_to_string(cfg.scheme) << " steps=" << cfg.steps
+                << " warmup=" << warmup << "\n"
+                << "mode,ranks,px,py,nx,ny,seconds,per_step,mlups,speedup,efficiency,"
+                   "karp_flatt\n";
+            json << "{\n  \"version\": \"" << CLIMATE_SIM_VERSION
+                 << "\",\n  \"threads\": " << max_threads() << ",\n  \"scheme\": \""
+                 << scheme_to_string(cfg.scheme) << "\",\n  \"steps\": " << cfg.steps
+                 << ",\n  \"warmup\": " << warmup << ",\n  \"runs\": [";
+
+            std::cout << std::setprecision(4);
+            const Run* base = nullptr;
+            for (size_t i = 0; i < runs.size(); ++i) {
+                const Run& r = runs[i];
+                if (r.ranks == 1) {
+                    base = &r;
+                    std::cout << r.mode << " scaling ("
+                              << (r.mode == "strong"
+                                      ? std::to_string(strong_nx) + " x " +
+                                            std::to_string(strong_ny) + " global"
+                                      : std::to_string(weak_nx) + " x " +
+                                            std::to_string(weak_ny) + " per rank")
+                              << ", " << cfg.steps << " steps):\n"
+                              << std::setw(7) << "ranks" << std::setw(9) << "grid"
+                              << std::setw(13) << "s/step" << std::setw(10) << "MLUPS"
+                              << std::setw(10) << "speedup" << std::setw(8) << "eff"
+                              << std::setw(12) << "karp-flatt" << "\n";
+                }
+                const Metrics m = metrics(r, *base);
+                const double per_step = r.seconds / cfg.steps;
+                const double lups = static_cast<double>(r.nx) * r.ny * cfg.tracers.count *
+                                    cfg.steps / r.seconds * 1e-6;
+                std::cout << std::setw(7) << r.ranks << std::setw(9)
+                          << std::to_string(r.px) + "x" + std::to_string(r.py) << std::setw(13)
+                          << per_step << std::setw(10) << lups << std::setw(10) << m.speedup
+                          << std::setw(8) << m.efficiency << std::setw(12)
+                          << (m.karp_flatt ? csv_opt(m.karp_flatt) : "-") << "\n";
+                csv << r.mode << "," << r.ranks << "," << r.px << "," << r.py << "," << r.nx
+                    << "," << r.ny << "," << r.seconds << "," << per_step << "," << lups << ","
+                    << m.speedup << "," << m.efficiency << "," << csv_opt(m.karp_flatt) << "\n";
+                json << (i ? ",\n" : "\n") << "    {\"mode\": \"" << r.mode
+                     << "\", \"ranks\": " << r.ranks << ", \"px\": " << r.px
+                     << ", \"py\": " << r.py << ", \"nx\": " << r.nx << ", \"ny\": " << r.ny
+                     << ", \"seconds\": " << r.seconds << ", \"per_step\": " << per_step
+                     << ", \"mlups\": " << lups << ", \"speedup\": " << m.speedup
+                     << ", \"efficiency\": " << m.efficiency
+                     << ", \"karp_flatt\": " << json_opt(m.karp_flatt) << "}";
+            }
+            json << "\n  ]\n}\n";
+            std::cout << "results: " << out << ".csv, " << out << ".json\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "bench_scaling: " << e.what() << "\n";
+        rc = 1;
+    }
+
+    MPI_Finalize();
+    return rc;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <mpi.h>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// `--key=value` / `--key value` command-line options of the benchmark drivers.
+class BenchArgs {
+   public:
+    BenchArgs(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            if (a.rfind("--", 0) != 0)
+                throw std::runtime_error("unexpected argument: " + a);
+            a = a.substr(2);
+            const size_t eq = a.find('=');
+            if (eq != std::string::npos)
+                values_[a.substr(0, eq)] = a.substr(eq + 1);
+            else if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0)
+                values_[a] = argv[++i];
+            else
+                values_[a] = "true";
+        }
+    }
+
+    bool has(const std::string& key) const { return values_.count(key) != 0; }
+
+    std::string str(const std::string& key, const std::string& def) const {
+        auto it = values_.find(key);
+        return it == values_.end() ? def : it->second;
+    }
+    int integer(const std::string& key, int def) const {
+        return has(key) ? std::stoi(values_.at(key)) : def;
+    }
+    double real(const std::string& key, double def) const {
+        return has(key) ? std::stod(values_.at(key)) : def;
+    }
+
+    // Comma-separated integers, e.g. `--sizes=64,128,256`.
+    std::vector<int> int_list(const std::string& key, const std::vector<int>& def) const {
+        if (!has(key))
+            return def;
+        std::vector<int> out;
+        std::stringstream ss(values_.at(key));
+        std::string item;
+        while (std::getline(ss, item, ','))
+            if (!item.empty())
+                out.push_back(std::stoi(item));
+        return out;
+    }
+
+   private:
+    std::map<std::string, std::string> values_;
+};
+
+// Best wall time per call of `fn` over `batches` batches, max over the ranks of `comm`. The batch
+// length is calibrated so a batch takes about `min_time / batches` seconds; all ranks run the same
+// number of calls, so `fn` may be collective.
+template <typename Fn>
+double best_seconds_per_call(Fn&& fn, double min_time, MPI_Comm comm, int batches = 5) {
+    fn();  // warm-up: first touch, persistent requests, caches
+
+    long iters = 1;
+    const double target = min_time / batches;
+    for (;;) {
+        MPI_Barrier(comm);
+        const double t0 = MPI_Wtime();
+        for (long i = 0; i < iters; ++i) fn();
+        double t = MPI_Wtime() - t0;
+        MPI_Allreduce(MPI_IN_PLACE, &t, 1, MPI_DOUBLE, MPI_MAX, comm);
+        if (t >= target || iters >= (1L << 30))
+            break;
+        iters = t > 0.0 ? std::max(iters * 2, static_cast<long>(iters * 1.2 * target / t))
+                        : iters * 16;
+    }
+
+    double best = 1e300;
+    for (int b = 0; b < batches; ++b) {
+        MPI_Barrier(comm);
+        const double t0 = MPI_Wtime();
+        for (long i = 0; i < iters; ++i) fn();
+        best = std::min(best, (MPI_Wtime() - t0) / iters);
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &best, 1, MPI_DOUBLE, MPI_MAX, comm);
+    return best;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "advection.hpp"
+#include "field.hpp"
+#include "tiling.hpp"
+
+// Single-pass explicit update: out = u + dt * (D * lap(u) - v . grad(u)), with first-order
+// upwind advection. Every interior cell of `out` is written exactly once and only the halo ring
+// is copied from `u`, so no preliminary full-field copy is needed. Equivalent to copying `u` into
+// `out` and then running diffusion_step followed by advection_step.
+template <typename T, typename Acc = T>
+void advect_diffuse_step(
+    const FieldT<T>& u, FieldT<T>& out, double D, double vx, double vy, double dt);
+
+// Fused update of the cells of `r` only (no ghost copy).
+template <typename T, typename Acc = T>
+void advect_diffuse_step(const FieldT<T>& u,
+                         FieldT<T>& out,
+                         double D,
+                         double vx,
+                         double vy,
+                         double dt,
+                         const Rect& r);
+
+// Reference-path update with cache blocking: for each tile runs diffusion_step and then
+// advection_step while the tile is still in cache, then copies the halo ring. Produces the same
+// values as std::copy + diffusion_step + advection_step over the whole field.
+template <typename T, typename Acc = T>
+void diffuse_advect_blocked_step(
+    const FieldT<T>& u, FieldT<T>& out, double D, double vx, double vy, double dt);
+
+// Tiled explicit update of `region` only (no ghost copy), through the fused kernel or the
+// diffusion + advection pair. `region` may extend into ghost layers that hold valid data.
+template <typename T, typename Acc = T>
+void explicit_update(const FieldT<T>& u,
+                     FieldT<T>& out,
+                     double D,
+                     double vx,
+                     double vy,
+                     double dt,
+                     bool fused,
+                     const Rect& region);
+
+// Fused update of a rect for one velocity direction (see AdvectionKernel); `ax`/`ay` are
+// D * dt / dx^2 and D * dt / dy^2.
+template <typename T>
+using AdvectDiffuseKernel = void (*)(const FieldT<T>& u,
+                                     FieldT<T>& out,
+                                     double ax,
+                                     double ay,
+                                     double cx,
+                                     double cy,
+                                     const Rect& r);
+
+template <typename T, typename Acc = T>
+AdvectDiffuseKernel<T> advect_diffuse_kernel(double vx, double vy);
@@ -1,4 +1,48 @@
 #pragma once
+#include <type_traits>
+
 #include "field.hpp"
+#include "tiling.hpp"
+
+template <typename T, typename Acc = T>
+void advection_step(const FieldT<T>& u, FieldT<T>& out, double vx, double vy, double dt);
+
+// Applies the upwind update to the cells of `r` only.
+template <typename T, typename Acc = T>
+void advection_step(
+    const FieldT<T>& u, FieldT<T>& out, double vx, double vy, double dt, const Rect& r);
+
+// Upwind direction of one velocity component as a compile-time value: +1 differences backward
+// (v > 0), -1 forward (v < 0), 0 drops the term (v == 0).
+template <int S>
+using UpwindSign = std::integral_constant<int, S>;
+
+// Calls `f(UpwindSign<SX>{}, UpwindSign<SY>{})` for the signs of (vx, vy). Kernels instantiated
+// per direction are picked this way once per sweep, so no row or cell tests the velocity.
+template <typename F>
+decltype(auto) with_upwind_signs(double vx, double vy, F&& f) {
+    auto along_y = [&](auto sx) -> decltype(auto) {
+        if (vy > 0.0)
+            return f(sx, UpwindSign<1>{});
+        if (vy < 0.0)
+            return f(sx, UpwindSign<-1>{});
+        return f(sx, UpwindSign<0>{});
+    };
+    if (vx > 0.0)
+        return along_y(UpwindSign<1>{});
+    if (vx < 0.0)
+        return along_y(UpwindSign<-1>{});
+    return along_y(UpwindSign<0>{});
+}
+
+// Upwind update of a rect for one velocity direction; `cx`/`cy` are the Courant numbers
+// dt * vx / dx and dt * vy / dy. The zero-velocity instance does nothing.
+template <typename T>
+using AdvectionKernel = void (*)(const FieldT<T>& u,
+                                 FieldT<T>& out,
+                                 double cx,
+                                 double cy,
+                                 const Rect& r);
 
-void advection_step(const Field& u, Field& out, double vx, double vy, double dt);
+template <typename T, typename Acc = T>
+AdvectionKernel<T> advection_kernel(double vx, double vy);
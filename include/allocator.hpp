@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Storage layout and placement policy for Field buffers.
+struct FieldLayout {
+    // Round the row pitch up to a cache line and offset the buffer so the first interior cell of
+    // every row starts on a 64-byte boundary.
+    bool pad_rows = false;
+    // Ask the kernel for transparent huge pages (madvise) on buffers of at least 2 MiB.
+    bool huge_pages = false;
+    // Place buffers in MPI-3 shared-memory windows so ranks on the same node can read each
+    // other's strips (halo backend `shm`, see shm.hpp). Allocation becomes collective over the
+    // node; huge_pages is ignored.
+    bool shared = false;
+};
+
+// Layout used by Field constructors that do not take one explicitly. Defaults to FieldLayout{}.
+void set_field_layout(FieldLayout layout);
+FieldLayout field_layout();
+
+constexpr size_t kFieldAlignment = 64;
+
+// Raw storage: 64-byte aligned, or 2 MiB aligned and madvise(MADV_HUGEPAGE)d when `huge_pages`
+// is set and the block is large enough. Throws std::bad_alloc on failure.
+void* field_alloc(size_t bytes, bool huge_pages);
+void field_free(void* p) noexcept;
+
+// Storage in a new shared window over the node (FieldLayout::shared); defined in shm.cpp.
+void* field_alloc_shared(size_t bytes);
+void field_free_shared(void* p) noexcept;
+
+// Allocator for Field storage. Elements are default-initialized rather than zeroed, so no page
+// is touched at allocation: Field writes its buffer with the same thread partitioning as the
+// kernels (first touch), which places each band of rows on the NUMA node of the thread that
+// will compute it.
+template <typename T>
+struct FieldAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    bool huge_pages = false;
+    bool shared = false;
+
+    FieldAllocator() = default;
+    explicit FieldAllocator(bool huge, bool shared_ = false) : huge_pages(huge), shared(shared_) {}
+    template <typename U>
+    FieldAllocator(const FieldAllocator<U>& other)
+        : huge_pages(other.huge_pages), shared(other.shared) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(shared ? field_alloc_shared(n * sizeof(T))
+                                      : field_alloc(n * sizeof(T), huge_pages));
+    }
+    void deallocate(T* p, size_t) noexcept { shared ? field_free_shared(p) : field_free(p); }
+
+    template <typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible<U>::value) {
+        ::new (static_cast<void*>(p)) U;
+    }
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const FieldAllocator<T>& a, const FieldAllocator<U>& b) {
+    return a.huge_pages == b.huge_pages && a.shared == b.shared;
+}
+template <typename T, typename U>
+bool operator!=(const FieldAllocator<T>& a, const FieldAllocator<U>& b) {
+    return !(a == b);
+}
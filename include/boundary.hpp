@@ -11,4 +11,5 @@ struct BCConfig {
     BCType top = BCType::Dirichlet;
 };
 
-void apply_boundary(Field& f, const Decomp2D& dec, const BCConfig& bc, double value);
+template <typename T>
+void apply_boundary(FieldT<T>& f, const Decomp2D& dec, const BCConfig& bc, double value);
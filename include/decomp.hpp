@@ -1,6 +1,21 @@
 #pragma once
 #include <mpi.h>
 
+#include <vector>
+
+// Process grid of a node-aware decomposition: `dims` process columns x rows, tiled by blocks of
+// `block[0] x block[1]` ranks that each fill one node.
+struct NodeGrid {
+    int dims[2]{1, 1};
+    int block[2]{1, 1};
+};
+
+// Node-aware process grid for `nodes` nodes of `per_node` ranks over an nx x ny grid. Among the
+// grids made of equal node blocks it picks the one with the least inter-node halo surface (cut
+// length between node blocks), then the least total surface; ties favor dims[0] >= dims[1], as
+// MPI_Dims_create does.
+NodeGrid choose_node_grid(int nodes, int per_node, int nx, int ny);
+
 struct Decomp2D {
     MPI_Comm cart_comm = MPI_COMM_NULL;
     int dims[2]{0, 0};
@@ -12,6 +27,31 @@ struct Decomp2D {
     int nx_local = 0, ny_local = 0;
     int x_offset = 0, y_offset = 0;
 
+    // First global column (row) of every process column (row), plus nx_global (ny_global) at the
+    // end: process column i owns [x_cuts[i], x_cuts[i + 1]).
+    std::vector<int> x_cuts, y_cuts;
+
+    // Node placement: the number of nodes, the ranks-per-node block of a node-aware grid (0 x 0
+    // for the flat one), and whether each neighbor shares this rank's node.
+    int nodes = 1;
+    int node_block[2]{0, 0};
+    bool lr_on_node[2]{false, false};
+    bool du_on_node[2]{false, false};
+
+    // Flat decomposition: MPI_Dims_create dims, cart rank = rank in `comm_world`.
     void init(MPI_Comm comm_world, int nx_global_, int ny_global_);
+
+    // Two-level decomposition (`decomp.node_aware`): the grid is tiled by node blocks
+    // (choose_node_grid) and the ranks of each node are renumbered into its block, so most
+    // neighbors share a node. Nodes are found with MPI_COMM_TYPE_SHARED, or taken as consecutive
+    // runs of `ranks_per_node` ranks when that is > 0. Falls back to init() when the nodes hold
+    // different numbers of ranks. Cart ranks then differ from the ranks in `comm_world`, so
+    // neighbor ranks are only valid in cart_comm.
+    void init_node_aware(MPI_Comm comm_world, int nx_global_, int ny_global_, int ranks_per_node);
     void finalize();
+
+    // Moves the tile boundaries (weighted decomposition) and updates the local extent. Every rank
+    // must pass the same cuts; throws std::runtime_error unless they are increasing and span the
+    // grid.
+    void set_cuts(const std::vector<int>& xc, const std::vector<int>& yc);
 };
@@ -1,4 +1,12 @@
 #pragma once
 #include "field.hpp"
+#include "tiling.hpp"
 
-void diffusion_step(const Field& u, Field& out, double D, double dt);
+// Kernels take the storage type `T` and the arithmetic type `Acc`: instantiated for double
+// (SIMD row kernels), float, and float storage with double arithmetic (mixed precision).
+template <typename T, typename Acc = T>
+void diffusion_step(const FieldT<T>& u, FieldT<T>& out, double D, double dt);
+
+// Updates only the cells of `r` (no ghost copy); used by blocked and split traversals.
+template <typename T, typename Acc = T>
+void diffusion_step(const FieldT<T>& u, FieldT<T>& out, double D, double dt, const Rect& r);
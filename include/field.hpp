@@ -1,21 +1,129 @@
 #pragma once
+#include <cassert>
+#include <cstddef>
 #include <stdexcept>
 #include <vector>
 
-struct Field {
+#include "allocator.hpp"
+
+// Marks row pointers in the hot loops as non-aliasing. Kernels always read from one Field and
+// write into another, so rows obtained from different fields never overlap.
+#if defined(__GNUC__) || defined(__clang__)
+#define FIELD_RESTRICT __restrict__
+#else
+#define FIELD_RESTRICT
+#endif
+
+// Lightweight non-owning view over a Field's storage. Row access is unchecked in release builds;
+// debug builds (no NDEBUG) assert on out-of-range rows and cells.
+template <typename T>
+struct BasicFieldView {
+    T* base = nullptr;
+    int pitch = 0;
+    int nx_local = 0, ny_local = 0;
+    int halo = 0;
+
+    int nx_total() const { return nx_local + 2 * halo; }
+    int ny_total() const { return ny_local + 2 * halo; }
+
+    T* row(int j) const {
+        assert(j >= 0 && j < ny_total());
+        return base + static_cast<size_t>(j) * pitch;
+    }
+    T& operator()(int i, int j) const {
+        assert(i >= 0 && i < nx_total());
+        return row(j)[i];
+    }
+};
+
+using FieldView = BasicFieldView<double>;
+using ConstFieldView = BasicFieldView<const double>;
+
+// How a Field holding several tracers stores them. `Planes` (SoA) keeps one full plane of rows
+// per tracer, back to back; `Interleaved` (AoS) stores the tracers of a cell next to each other,
+// so a row holds nx_total() * count values.
+enum class TracerLayout { Planes, Interleaved };
+
+struct Tracers {
+    int count = 1;
+    TracerLayout layout = TracerLayout::Planes;
+};
+
+// Field over scalar type `T`; instantiated for double and float (see `precision`).
+//
+// A field may carry several tracers advanced by the same kernels. Kernels see it as planes() planes
+// whose rows hold cell_width() consecutive values per cell: tracers() planes of width 1 for
+// `Planes`, one plane of width tracers() for `Interleaved`.
+template <typename T>
+struct FieldT {
+    using value_type = T;
+
     int nx_local, ny_local;
     int halo;
     double dx, dy;
-    std::vector<double> data;
+    Tracers tracer;
+    int pitch;      // elements between the starts of consecutive rows (>= nx_total() * width)
+    size_t plane;   // elements between the starts of consecutive tracer planes
+    size_t origin;  // index of cell (0, 0) in `data`
+    std::vector<T, FieldAllocator<T>> data;
 
-    Field(int nx, int ny, int h, double dx_, double dy_);
+    FieldT(int nx, int ny, int h, double dx_, double dy_);
+    FieldT(int nx, int ny, int h, double dx_, double dy_, const FieldLayout& layout);
+    FieldT(int nx, int ny, int h, double dx_, double dy_, const Tracers& tracers);
+    FieldT(int nx,
+           int ny,
+           int h,
+           double dx_,
+           double dy_,
+           const Tracers& tracers,
+           const FieldLayout& layout);
 
-    inline size_t idx(int i, int j) const;
-    double& at(int i, int j);
-    const double& at(int i, int j) const;
+    // Index of tracer `k` of cell (i, j).
+    inline size_t idx(int i, int j, int k = 0) const;
+    T& at(int i, int j, int k = 0);
+    const T& at(int i, int j, int k = 0) const;
 
     int nx_total() const { return nx_local + 2 * halo; }
     int ny_total() const { return ny_local + 2 * halo; }
 
-    void fill(double value);
+    int tracers() const { return tracer.count; }
+    bool interleaved() const { return tracer.layout == TracerLayout::Interleaved; }
+    int planes() const { return interleaved() ? 1 : tracer.count; }
+    int cell_width() const { return interleaved() ? tracer.count : 1; }
+
+    // Unchecked (debug-asserted) access for hot loops; `at()` stays the checked accessor. Rows
+    // index plane `p` (tracer p for `Planes`, all tracers for `Interleaved`).
+    T* row(int j, int p = 0) {
+        assert(j >= 0 && j < ny_total() && p >= 0 && p < planes());
+        return data.data() + origin + p * plane + static_cast<size_t>(j) * pitch;
+    }
+    const T* row(int j, int p = 0) const {
+        assert(j >= 0 && j < ny_total() && p >= 0 && p < planes());
+        return data.data() + origin + p * plane + static_cast<size_t>(j) * pitch;
+    }
+
+    // View of plane 0 with one value per cell: the whole field when it holds a single tracer.
+    // An interleaved field with several tracers has no such plane, which debug builds assert.
+    BasicFieldView<T> view() {
+        assert(cell_width() == 1);
+        return {data.data() + origin, pitch, nx_local, ny_local, halo};
+    }
+    BasicFieldView<const T> view() const {
+        assert(cell_width() == 1);
+        return {data.data() + origin, pitch, nx_local, ny_local, halo};
+    }
+
+    // Writes `value` everywhere, padding included, with the kernels' row partitioning.
+    void fill(T value);
 };
+
+using Field = FieldT<double>;
+using FieldF = FieldT<float>;
+
+extern template struct FieldT<double>;
+extern template struct FieldT<float>;
+
+// Copies every ghost cell (all `halo` layers on each side, every tracer) of `src` into `dst`. Both
+// fields must share the same shape.
+template <typename T>
+void copy_halo_ring(const FieldT<T>& src, FieldT<T>& dst);
@@ -1,7 +1,171 @@
 #pragma once
 #include <mpi.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "decomp.hpp"
 #include "field.hpp"
+#include "shm.hpp"
+#include "tiling.hpp"
+
+// Ghost sides an exchange fills, as a bit mask. Every rank must pass the same mask: filling the
+// left ghosts means receiving from the left neighbor and sending to the right one.
+enum HaloSides : unsigned {
+    kHaloLeft = 1u,
+    kHaloRight = 2u,
+    kHaloDown = 4u,
+    kHaloUp = 8u,
+    kHaloAll = 15u,
+};
+
+// Ghost sides the upwind stencil reads for velocity (vx, vy): the side each component blows from.
+inline unsigned upwind_sides(double vx, double vy) {
+    return (vx > 0 ? kHaloLeft : 0u) | (vx < 0 ? kHaloRight : 0u) | (vy > 0 ? kHaloDown : 0u) |
+           (vy < 0 ? kHaloUp : 0u);
+}
+
+// How HaloPlan moves the ghost strips (`perf.halo_backend`).
+//  - p2p: persistent MPI_Send_init / MPI_Recv_init requests per neighbor.
+//  - shm: neighbors on the same node copy each other's strips straight out of MPI-3 shared-memory
+//    windows (see shm.hpp); only off-node neighbors get messages. Applies to field buffers
+//    allocated with FieldLayout::shared, other buffers use p2p. Building a plan is then collective
+//    over the plan's communicator.
+//  - rma: every field buffer is exposed through an MPI_Win and each rank MPI_Puts its strips
+//    into the neighbors' ghosts, synchronized by post/start/complete/wait on the neighbor group.
+//    Building a plan, binding a buffer and destroying the plan are collective over the plan's
+//    communicator.
+//  - neighbor: the Cartesian neighbors form a distributed graph topology
+//    (MPI_Dist_graph_create_adjacent) and each phase is a single MPI_Ineighbor_alltoallw over
+//    the column and row datatypes, leaving scheduling and aggregation to the MPI library.
+//    Building and destroying a plan are collective over the plan's communicator.
+enum class HaloBackend { P2P, Shm, Rma, Neighbor };
+
+HaloBackend halo_backend_from_string(const std::string& s);
+std::string halo_backend_to_string(HaloBackend b);
+
+// Backend of the HaloPlans built from now on; process-wide, P2P by default.
+void set_halo_backend(HaloBackend b);
+HaloBackend halo_backend();
+
+// Halo exchange for fields of one shape, built once and reused every step. The column/row
+// datatypes are committed at construction; each field buffer gets persistent send/receive
+// requests (MPI_Send_init / MPI_Recv_init) on first use, which begin() restarts with
+// MPI_Startall.
+//
+// Between begin() and end() the field's interior must not be written and its ghosts not read.
+class HaloPlan {
+   public:
+    // `f` fixes the shape, pitch, tracers and element type (double or float) of the fields
+    // exchanged. All tracers travel in one message per neighbor and direction.
+    template <typename T>
+    HaloPlan(const FieldT<T>& f, const Decomp2D& dec, MPI_Comm comm);
+    ~HaloPlan();
+    HaloPlan(const HaloPlan&) = delete;
+    HaloPlan& operator=(const HaloPlan&) = delete;
+
+    // Starts the exchange for `f`. With halo > 1 only the columns go out here; the rows, which
+    // carry the corners, follow in end(). `sides` limits the exchange to the ghosts a stencil
+    // actually reads; the other ghosts keep their previous values.
+    template <typename T>
+    void begin(FieldT<T>& f, unsigned sides = kHaloAll);
+
+    // Completes the exchange; afterwards every ghost layer facing a neighbor rank is filled.
+    void end();
+
+    template <typename T>
+    void exchange(FieldT<T>& f, unsigned sides = kHaloAll) {
+        begin(f, sides);
+        end();
+    }
+
+    // Bytes this rank sends as messages in one exchange of `sides`, and in total through the plan
+    // so far. Strips that on-node neighbors read from shared memory are not counted.
+    long long send_bytes(unsigned sides = kHaloAll) const;
+    long long bytes_sent() const { return bytes_sent_; }
+    // The part of bytes_sent() that went to neighbors on this rank's node (Decomp2D::lr_on_node,
+    // du_on_node); the rest crossed the interconnect.
+    long long bytes_sent_on_node() const { return bytes_sent_on_node_; }
+
+   private:
+    struct Requests {
+        const void* base = nullptr;
+        const SharedBuffer* shared = nullptr;  // shm: the buffer's window; null for p2p only
+        MPI_Win win = MPI_WIN_NULL;            // rma: the whole buffer, displacements in bytes
+        std::vector<MPI_Request> cols, rows;
+        std::vector<unsigned> col_sides, row_sides;  // ghost side each request serves
+    };
+
+    int nx_, ny_, h_, pitch_;
+    int tracers_;
+    bool interleaved_;
+    int left_, right_, down_, up_;
+    MPI_Comm comm_;
+    MPI_Datatype elem_;
+    MPI_Datatype colType_ = MPI_DATATYPE_NULL;
+    MPI_Datatype rowType_ = MPI_DATATYPE_NULL;
+    int row_x0_ = 0;  // first cell of the row strips: h_ when they skip the corner ghosts
+    std::vector<Requests> bound_;
+    Requests* active_ = nullptr;
+    unsigned sides_ = kHaloAll;
+    int col_bytes_ = 0, row_bytes_ = 0;
+    long long bytes_sent_ = 0, bytes_sent_on_node_ = 0;
+    unsigned on_node_ = 0;  // sides whose neighbor shares this rank's node
+    std::unique_ptr<ShmLinks> shm_;  // shm backend: on-node neighbors
+    unsigned linked_ = 0;            // sides whose neighbor is linked through shm_
+    int cell_bytes_ = 0;
+    HaloBackend backend_;
+    // rma: per neighbor side (0 = left, 1 = right, 2 = down, 3 = up), the strip put there: its
+    // byte offset in this rank's buffer, its byte offset and layout in the neighbor's buffer.
+    MPI_Group nbr_group_ = MPI_GROUP_NULL;
+    MPI_Aint put_src_[4] = {}, put_dst_[4] = {};
+    MPI_Datatype put_type_[4] = {MPI_DATATYPE_NULL, MPI_DATATYPE_NULL, MPI_DATATYPE_NULL,
+                                 MPI_DATATYPE_NULL};
+
+    // neighbor: one entry per graph edge, in the order given to MPI_Dist_graph_create_adjacent.
+    // `sides` is the ghost side the message fills (this rank's for receives, the neighbor's for
+    // sends); `counts` and `addrs` are rebuilt for every phase.
+    struct Edges {
+        std::vector<int> counts;
+        std::vector<MPI_Aint> displs;  // bytes from the buffer start
+        std::vector<MPI_Aint> addrs;   // absolute addresses in the active buffer
+        std::vector<MPI_Datatype> types;
+        std::vector<unsigned> sides;
+    };
+    MPI_Comm graph_ = MPI_COMM_NULL;
+    Edges recv_edges_, send_edges_;
+    MPI_Request coll_ = MPI_REQUEST_NULL;
+
+    template <typename T>
+    Requests& requests_for(FieldT<T>& f);
+    long long message_bytes(unsigned sides, unsigned skip) const;
+    template <typename T>
+    void init_rma(const FieldT<T>& f);
+    void put_strips(bool rows);
+    void open_epoch();
+    void close_epoch();
+    template <typename T>
+    void init_graph(const FieldT<T>& f);
+    void start_alltoallw(unsigned phase);
+    void copy_strip(const char* src,
+                    const ShmGeometry& from,
+                    long long src_x,
+                    int src_j,
+                    long long dst_x,
+                    int dst_j,
+                    int rows,
+                    size_t len);
+    void copy_shared_columns();
+    void copy_shared_rows();
+};
+
+// One-off exchange through a temporary plan. Fills all `f.halo` ghost layers facing a neighbor
+// rank, corners included when halo > 1.
+template <typename T>
+void exchange_halos(FieldT<T>& f, const Decomp2D& dec, MPI_Comm comm);
 
-void exchange_halos(Field& f, const Decomp2D& dec, MPI_Comm comm);
+// Interior of `f` grown by `e` cells into the ghost layers on every side that faces a neighbor
+// rank; physical boundaries are never crossed.
+template <typename T>
+Rect expanded_interior(const FieldT<T>& f, const Decomp2D& dec, int e);
@@ -0,0 +1,54 @@
+#pragma once
+#include <mpi.h>
+
+#include <vector>
+
+#include "boundary.hpp"
+#include "decomp.hpp"
+#include "field.hpp"
+#include "halo.hpp"
+#include "io.hpp"
+
+// Backward-Euler diffusion, (I - dt * D * lap) u_new = u, solved with conjugate gradients over
+// all ranks. Ghosts follow the configured BCs (Dirichlet 0, Neumann copy), which keeps the
+// operator symmetric positive definite for every combination.
+//
+// CG iterates on the increment d = u_new - u and starts from the previous step's increment, so
+// a smoothly evolving field leaves only a small correction to converge. No preconditioner: the
+// diagonal is constant away from Neumann edges, so Jacobi would only rescale. Work vectors are
+// double whatever the field precision. Dot products are summed row by row in a fixed order, so
+// results do not depend on the thread count (they do on the rank count).
+class ImplicitDiffusion {
+   public:
+    ImplicitDiffusion(const SimConfig& cfg, const Decomp2D& dec, MPI_Comm comm);
+
+    // Replaces the interior of `u` by the backward-Euler update; ghosts are left as they were.
+    // Returns the CG iterations taken. Throws if `cg_max_iter` iterations do not reach
+    // `cg_tol`.
+    template <typename T>
+    int solve(FieldT<T>& u);
+
+    // Changes the step the next solve advances by (adaptive dt).
+    void set_dt(double dt);
+
+    long iterations() const { return iterations_; }  // over all solves
+    long long halo_bytes() const { return plan_.bytes_sent(); }
+    long long halo_bytes_on_node() const { return plan_.bytes_sent_on_node(); }
+
+   private:
+    const Decomp2D& dec_;
+    MPI_Comm comm_;
+    BCConfig bc_;
+    double kx_, ky_;  // D / dx^2, D / dy^2
+    double ax_, ay_;  // the same times dt
+    double tol_;
+    int max_iter_;
+    long iterations_ = 0;
+
+    Field x_, d_, r_, p_, q_;     // right-hand side, increment, residual, direction, A * p
+    std::vector<double> partial_;  // per-row partial sums of the current dot product
+    HaloPlan plan_;
+
+    void refresh_ghosts(Field& f);
+    double allreduce(double local) const;
+};
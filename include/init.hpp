@@ -3,4 +3,7 @@
 #include "field.hpp"
 #include "io.hpp"
 
-void apply_initial_condition(const Decomp2D& dec, Field& u, const SimConfig& cfg);
\ No newline at end of file
+// Evaluated in double and stored as T. With several tracers, tracer k gets the configured profile
+// scaled by 1 / (k + 1), so the tracers stay distinguishable in the output.
+template <typename T>
+void apply_initial_condition(const Decomp2D& dec, FieldT<T>& u, const SimConfig& cfg);
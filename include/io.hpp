@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <vector>
@@ -18,6 +19,45 @@ struct ICConfig {
     std::string var;
 };
 
+// Field storage and kernel arithmetic: double/double, float/float, or float storage with double
+// arithmetic (`mixed`). Output variables are NC_FLOAT unless the precision is double.
+enum class Precision { Double, Float, Mixed };
+
+// Diffusion time integration. Advection is explicit upwind in every scheme.
+//  - explicit: forward Euler, dt limited by D * dt * (1/dx^2 + 1/dy^2) <= 1/2.
+//  - implicit: backward Euler solved with distributed CG each step; unconditionally stable, so
+//    only the advection CFL limits dt.
+//  - rkl2: Runge-Kutta-Legendre super-time-stepping; s explicit stages per step with s chosen
+//    from dt, stable up to (s^2 + s - 2) / 4 times the forward-Euler limit.
+//  - subcycle: operator splitting; dt follows the looser of the advective and diffusive limits
+//    and the stiffer term (either one) takes explicit substeps under its own limit.
+enum class TimeScheme { Explicit, Implicit, Rkl2, Subcycle };
+
+struct PerfConfig {
+    bool fused = false;
+    std::string simd = "auto";
+    int tile_x = 0, tile_y = 0;
+    int halo_depth = 1;
+    bool overlap = true;
+    int threads = 0;  // per rank; 0 = OpenMP default (OMP_NUM_THREADS)
+    bool pad_rows = false;
+    bool huge_pages = false;
+    std::string halo_backend = "p2p";  // p2p | shm | rma | neighbor (see HaloBackend)
+    std::string phase_report;  // per-phase timing report (.csv or JSON); empty = none
+};
+
+// Weighted decomposition: every `rebalance_every` steps the cuts between process columns and rows
+// move toward equal measured compute time per rank (see LoadBalancer), when the measured
+// imbalance exceeds `rebalance_tol`.
+struct DecompConfig {
+    int rebalance_every = 0;  // 0 = static tiles
+    double rebalance_tol = 0.05;
+    // Two-level process grid of node blocks (Decomp2D::init_node_aware); nodes are detected
+    // unless `ranks_per_node` > 0.
+    bool node_aware = false;
+    int ranks_per_node = 0;
+};
+
 struct SimConfig {
     int nx = 256, ny = 256;
     double dx = 1.0, dy = 1.0;
@@ -29,12 +69,34 @@ struct SimConfig {
     int steps = 100;
     int out_every = 50;
 
+    // Adaptive dt (see TimeController): `dt` then only sets the output times and t_end.
+    bool adaptive_dt = false;
+    double cfl = 0.9;  // fraction of the stability limit used
+    int dt_every = 1;  // steps between limit refreshes
+
+    TimeScheme scheme = TimeScheme::Explicit;
+    double cg_tol = 1e-6;  // implicit: stop once ||residual|| <= cg_tol * ||u||
+    int cg_max_iter = 500;
+
     BCConfig bc;
 
+    Precision precision = Precision::Double;
+
+    // Scalars transported together by the same velocity and diffusivity (see Tracers).
+    Tracers tracers{};
+
     std::string output_prefix = "snap";
 
+    // Machine-readable run report: "" (none) or "json", written by rank 0 to `report_path`.
+    std::string report;
+    std::string report_path = "outputs/report.json";
+
     ICConfig ic{};
 
+    PerfConfig perf{};
+
+    DecompConfig decomp{};
+
     void validate() const;
 };
 
@@ -46,15 +108,45 @@ struct CLIOverrides {
 
     std::optional<double> dt;
     std::optional<int> steps, out_every;
+    std::optional<bool> adaptive_dt;
+    std::optional<double> cfl;
+    std::optional<int> dt_every;
+    std::optional<TimeScheme> scheme;
+    std::optional<double> cg_tol;
+    std::optional<int> cg_max_iter;
 
     std::optional<BCType> bc_left, bc_right, bc_bottom, bc_top;
 
+    std::optional<Precision> precision;
+
+    std::optional<int> tracer_count;
+    std::optional<TracerLayout> tracer_layout;
+
     std::optional<std::string> output_prefix;
+    std::optional<std::string> report, report_path;
 
     struct {
         std::optional<std::string> mode, preset, path, format, var;
         std::optional<double> A, sigma_frac, xc_frac, yc_frac;
     } ic;
+
+    struct {
+        std::optional<bool> fused;
+        std::optional<std::string> simd;
+        std::optional<int> tile_x, tile_y;
+        std::optional<int> halo_depth;
+        std::optional<bool> overlap;
+        std::optional<int> threads;
+        std::optional<bool> pad_rows, huge_pages;
+        std::optional<std::string> halo_backend, phase_report;
+    } perf;
+
+    struct {
+        std::optional<int> rebalance_every;
+        std::optional<double> rebalance_tol;
+        std::optional<bool> node_aware;
+        std::optional<int> ranks_per_node;
+    } decomp;
 };
 
 SimConfig load_yaml_file(const std::string& path);
@@ -67,6 +159,20 @@ SimConfig merged_config(const std::optional<std::string>& yaml_path,
 BCType bc_from_string(const std::string& s);
 std::string bc_to_string(BCType bc);
 
+Precision precision_from_string(const std::string& s);
+std::string precision_to_string(Precision p);
+// Bytes per stored field value: 8 for double, 4 for float and mixed.
+size_t precision_storage_bytes(Precision p);
+
+TimeScheme scheme_from_string(const std::string& s);
+std::string scheme_to_string(TimeScheme s);
+
+TracerLayout tracer_layout_from_string(const std::string& s);
+std::string tracer_layout_to_string(TracerLayout layout);
+
+// NetCDF variable of tracer `k`: "u" for the first, then "u_1", "u_2", ...
+std::string tracer_var_name(int k);
+
 int open_netcdf_parallel(const std::string& filename,
                          const Decomp2D& dec,
                          const SimConfig& cfg,
@@ -74,7 +180,17 @@ int open_netcdf_parallel(const std::string& filename,
                          int& ncid,
                          int& varid);
 
-bool write_field_netcdf(int ncid, int varid, const Field& f, const Decomp2D& dec, int step);
+// Writes the simulation time of record `step` into the `time` coordinate variable.
+bool write_time_netcdf(int ncid, int step, double t, const Decomp2D& dec);
+
+// Copies the interior of tracer `k` of `f` into `dst` (nx_local * ny_local values, row-major).
+template <typename T>
+void pack_interior(const FieldT<T>& f, int k, T* dst);
+
+// Writes the interior of `f` at time index `step`; float fields go out as float. Tracer k goes to
+// variable `varid + k` (open_netcdf_parallel defines them in that order).
+template <typename T>
+bool write_field_netcdf(int ncid, int varid, const FieldT<T>& f, const Decomp2D& dec, int step);
 
 void close_netcdf_parallel(int ncid);
 
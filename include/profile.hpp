@@ -0,0 +1,87 @@
+#pragma once
+#include <mpi.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Phases of the time loop, timed separately so a slow run can be attributed to compute,
+// communication or I/O.
+enum class Phase {
+    HaloPost,        // posting halo receives/sends
+    HaloWait,        // blocked until the halo messages complete
+    Boundary,        // physical BCs and the ghost ring copied into the output buffer
+    KernelInterior,  // update of the cells that read no ghosts (overlapped with the exchange)
+    KernelEdges,     // update of the strips next to the ghosts (or the whole region)
+    KernelSplit,     // split-off term: implicit/RKL2 diffusion or the subcycled term
+    Swap,            // swapping the field buffers
+    Output,          // NetCDF snapshots
+    Rebalance,       // moving the tile cuts and migrating the fields (decomp.rebalance_every)
+};
+constexpr int kPhaseCount = 9;
+
+std::string phase_to_string(Phase p);
+
+// Wall time and call count accumulated per phase on one rank.
+struct PhaseTimes {
+    double seconds[kPhaseCount] = {};
+    long calls[kPhaseCount] = {};
+
+    void add(Phase p, double s) {
+        seconds[static_cast<int>(p)] += s;
+        ++calls[static_cast<int>(p)];
+    }
+    double operator[](Phase p) const { return seconds[static_cast<int>(p)]; }
+    PhaseTimes& operator+=(const PhaseTimes& o);
+};
+
+// Adds the wall time from construction to destruction to `phase`.
+class ScopedPhase {
+   public:
+    ScopedPhase(PhaseTimes& times, Phase phase) : times_(times), phase_(phase), t0_(MPI_Wtime()) {}
+    ~ScopedPhase() { times_.add(phase_, MPI_Wtime() - t0_); }
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+   private:
+    PhaseTimes& times_;
+    Phase phase_;
+    double t0_;
+};
+
+// One phase across the ranks of a communicator. `imbalance` = max / mean - 1: 0 when every rank
+// spends the same time, 1 when the slowest rank spends twice the average.
+struct PhaseStats {
+    Phase phase;
+    double min = 0.0, mean = 0.0, max = 0.0, imbalance = 0.0;
+    long calls = 0;  // on the rank with the most calls
+};
+
+// Reduces every phase over `comm`; collective, the result is valid on every rank.
+std::vector<PhaseStats> reduce_phase_times(const PhaseTimes& times, MPI_Comm comm);
+
+// Million lattice updates per second: `cell_updates` cell updates in `seconds`.
+double mlups(double cell_updates, double seconds);
+
+// Summary of a run written by write_phase_report().
+struct PhaseReport {
+    int ranks = 1;
+    int threads = 1;
+    int nx = 0, ny = 0, tracers = 1;
+    long steps = 0;
+    double loop_seconds = 0.0;     // time loop, max over ranks
+    double compute_seconds = 0.0;  // time loop without the output phase, max over ranks
+    std::vector<PhaseStats> phases;
+
+    // Throughput of the whole loop and of the loop without output.
+    double mlups() const;
+    double compute_mlups() const;
+};
+
+// Writes `phases` as a JSON array, one object per phase; `indent` prefixes the continuation lines.
+void write_phases_json(std::ostream& os, const std::vector<PhaseStats>& phases,
+                       const std::string& indent);
+
+// Writes `r` as CSV (one row per phase) when `path` ends in ".csv", as JSON otherwise. Throws
+// std::runtime_error if the file cannot be written.
+void write_phase_report(const std::string& path, const PhaseReport& r);
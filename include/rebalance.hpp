@@ -0,0 +1,86 @@
+#pragma once
+#include <mpi.h>
+
+#include <vector>
+
+#include "decomp.hpp"
+#include "field.hpp"
+#include "io.hpp"
+#include "profile.hpp"
+
+// Weighted decomposition (`decomp.rebalance_every`). The process grid stays fixed, but the cuts
+// between process columns and rows move so that every rank spends about the same compute time per
+// step. Costs are measured rather than modelled, so a rank on a slower core, or one whose cells
+// cost more, ends up with a smaller tile.
+//
+// Cost grids are indexed by process coordinates, `cost[i + dims[0] * j]` for the tile in process
+// column i and row j.
+
+// max / mean - 1 of `costs`: 0 when balanced, as PhaseStats::imbalance.
+double load_imbalance(const std::vector<double>& costs);
+
+// New cuts for one dimension. `cuts` holds the current dims + 1 boundaries and `slab_cost` the
+// measured cost of each slab between them, taken as uniform within a slab. Every cut moves to the
+// position that splits the total cost evenly, but not past the neighboring old cuts, so a new tile
+// only overlaps its old tile and the adjacent ones. No slab ends up narrower than `min_width`.
+std::vector<int> balance_cuts(const std::vector<int>& cuts,
+                              const std::vector<double>& slab_cost,
+                              int min_width);
+
+// Cost grid after moving the cuts from `old_x`/`old_y` to `new_x`/`new_y`, with the cost of every
+// old tile spread uniformly over its cells.
+std::vector<double> predicted_costs(const std::vector<double>& cost,
+                                    const std::vector<int>& old_x,
+                                    const std::vector<int>& old_y,
+                                    const std::vector<int>& new_x,
+                                    const std::vector<int>& new_y);
+
+// Copies the interior of `src`, laid out under the cuts `old_x`/`old_y`, into `dst`, laid out
+// under the current cuts of `dec` (every tracer; ghosts untouched). Collective over
+// dec.cart_comm; cells only move between a rank and its eight neighbors, so the cuts must not have
+// moved past a neighboring old cut (as balance_cuts guarantees). Returns the cells this rank
+// received from other ranks.
+template <typename T>
+long long migrate_field(const FieldT<T>& src,
+                        FieldT<T>& dst,
+                        const Decomp2D& dec,
+                        const std::vector<int>& old_x,
+                        const std::vector<int>& old_y);
+
+// Compute time of a rank from its step phases: what a smaller tile makes cheaper, excluding the
+// time spent waiting for neighbors.
+double busy_seconds(const PhaseTimes& times);
+
+// Outcome of one LoadBalancer::rebalance() call; the same on every rank.
+struct RebalanceStats {
+    long step = 0;
+    bool moved = false;
+    double imbalance_before = 0.0;  // measured over the period since the previous call
+    double imbalance_after = 0.0;   // predicted for the new cuts (measured at the next call)
+    long long cells_moved = 0;      // cells that changed owner, all ranks
+};
+
+// Runtime rebalancing of the tile cuts of a Decomp2D. Every `decomp.rebalance_every` steps the
+// ranks share their compute time since the previous call (MPI_Allgather); when its imbalance
+// exceeds `decomp.rebalance_tol` the cuts move (balance_cuts on the column and row sums) and the
+// fields migrate to their new owners.
+class LoadBalancer {
+   public:
+    explicit LoadBalancer(const SimConfig& cfg);
+
+    bool enabled() const { return every_ > 0; }
+    bool due(long step) const { return every_ > 0 && step > 0 && step % every_ == 0; }
+
+    // Collective over dec.cart_comm. `busy` is this rank's cumulative compute time (busy_seconds);
+    // the period since the previous call is what gets balanced. When the cuts move, `u` is
+    // migrated and `tmp` reallocated to the new tile (same halo and tracers); the caller must then
+    // reset the stepper (BasicStepper::reset_decomposition).
+    template <typename T>
+    RebalanceStats rebalance(Decomp2D& dec, long step, double busy, FieldT<T>& u, FieldT<T>& tmp);
+
+   private:
+    int every_;
+    int min_width_;
+    double tol_;
+    double last_busy_ = 0.0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <mpi.h>
+
+#include <string>
+#include <vector>
+
+#include "decomp.hpp"
+#include "io.hpp"
+#include "profile.hpp"
+#include "rebalance.hpp"
+
+// Peak resident set size of this process in KiB (VmHWM from /proc/self/status), or -1 where that
+// is not available.
+long peak_rss_kb();
+
+// Measurements of one rank for the run report.
+struct RankStats {
+    int rank = 0;
+    int coords[2] = {0, 0};
+    int nx_local = 0, ny_local = 0;
+    int x_offset = 0, y_offset = 0;
+    double step_min = 0.0, step_mean = 0.0, step_max = 0.0;  // seconds per step
+    double halo_bytes_per_step = 0.0;                        // sent by this rank
+    double halo_on_node_bytes_per_step = 0.0;                // of which to on-node neighbors
+    long peak_rss_kb = -1;
+};
+
+// Collects every rank's stats on rank 0 of `comm` (ordered by rank); other ranks get an empty
+// vector. Collective.
+std::vector<RankStats> gather_rank_stats(const RankStats& local, MPI_Comm comm);
+
+// Structured summary of a run (`report: json`), written by rank 0.
+struct RunReport {
+    SimConfig cfg;              // effective config, after CLI overrides and dt clamping
+    double dt_requested = 0.0;  // dt before clamping to the stability limit
+    int dims[2] = {1, 1};
+    int nodes = 1;
+    int node_block[2] = {0, 0};  // ranks per node block; 0 x 0 for the flat grid
+    std::vector<int> x_cuts, y_cuts;  // final tile cuts (Decomp2D)
+    std::vector<RebalanceStats> rebalances;
+    long steps = 0;
+    double sim_time = 0.0;
+    std::vector<RankStats> ranks;
+    long output_records = 0;
+    double output_bytes = 0.0;    // field and time values written, all ranks
+    double output_seconds = 0.0;  // output phase, max over ranks
+    PhaseReport phases;
+};
+
+// Writes `r` as JSON to `path`. Throws std::runtime_error if the file cannot be written.
+void write_run_report(const std::string& path, const RunReport& r);
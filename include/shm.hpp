@@ -0,0 +1,94 @@
+#pragma once
+#include <mpi.h>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// MPI-3 shared memory for the `shm` halo backend (`perf.halo_backend: shm`).
+//
+// Field buffers allocated with FieldLayout::shared live in MPI_Win_allocate_shared windows over
+// the ranks of a node, so a rank can address the buffers of its on-node neighbors and copy their
+// boundary strips straight into its ghosts. Allocating and freeing such a buffer is collective
+// over the node: every rank must create and destroy its shared fields in the same order, which
+// the solver code does since all ranks run the same allocations.
+
+// Splits `comm` by node (MPI_Comm_split_type(MPI_COMM_TYPE_SHARED)) and enables shared field
+// buffers on it. Collective over `comm`.
+void enable_shared_fields(MPI_Comm comm);
+
+// Releases the node communicator; every shared field must have been destroyed. Collective.
+void disable_shared_fields();
+
+bool shared_fields_enabled();
+
+// A field buffer in a shared window: `peers[r]` is where node rank r's buffer of the same window
+// is mapped in this process. `id` counts the allocations, so buffers created in the same order on
+// different ranks carry the same id.
+struct SharedBuffer {
+    long id = -1;
+    MPI_Win win = MPI_WIN_NULL;
+    char* base = nullptr;
+    std::vector<char*> peers;
+};
+
+// The shared buffer starting at `p`, or nullptr when `p` was not allocated in a shared window.
+const SharedBuffer* find_shared_buffer(const void* p);
+
+// Layout of one rank's field buffer, in bytes, so its neighbors can locate its strips.
+struct ShmGeometry {
+    long long origin = 0;  // cell (0, 0) of plane 0
+    long long pitch = 0;   // between rows
+    long long plane = 0;   // between tracer planes
+    int nx_local = 0, ny_local = 0;
+};
+
+// Synchronization between a rank and its on-node Cartesian neighbors for one HaloPlan. Sides are
+// indexed 0 = left, 1 = right, 2 = down, 3 = up.
+//
+// Each rank publishes, in a small shared window, a sequence number per exchange phase: `ready`
+// once its interior may be read (begin), `columns` once its ghost columns are filled (deep halos
+// read the corners from them), and `done` once it has finished reading its neighbors. A rank
+// leaves end() only after all on-node neighbors are done, so nobody overwrites a strip that is
+// still being read. Waiting spins on the flags and keeps MPI progressing for the off-node
+// messages.
+class ShmLinks {
+   public:
+    enum Flag { Ready = 0, Columns = 1, Done = 2 };
+
+    // Collective over `comm`. `nbrs` are the Cartesian neighbors in `comm` (or MPI_PROC_NULL).
+    ShmLinks(MPI_Comm comm, const int nbrs[4], const ShmGeometry& mine);
+    ~ShmLinks();
+    ShmLinks(const ShmLinks&) = delete;
+    ShmLinks& operator=(const ShmLinks&) = delete;
+
+    // Whether neighbor `s` shares this node (and its strips are read, not sent).
+    bool linked(int s) const { return ctl_peer_[s] >= 0; }
+    const ShmGeometry& geometry(int s) const;
+    const ShmGeometry& own_geometry() const;
+
+    // Starts the next exchange on `buf`: publishes Ready.
+    void post_ready(const SharedBuffer* buf);
+    void post(Flag f);
+
+    // Waits until neighbor `s` has reached `f` in the current exchange and returns the mapping of
+    // its buffer. Throws std::runtime_error when the neighbor exchanges a different buffer.
+    const char* wait(int s, Flag f);
+
+    // Publishes Done and waits for every linked neighbor's Done.
+    void finish();
+
+   private:
+    struct Control;
+
+    MPI_Comm comm_, node_ = MPI_COMM_NULL;
+    MPI_Win win_ = MPI_WIN_NULL;
+    Control* mine_ = nullptr;
+    Control* peer_ctl_[4] = {};
+    int ctl_peer_[4] = {-1, -1, -1, -1};    // neighbor's rank in node_, or -1
+    int field_peer_[4] = {-1, -1, -1, -1};  // neighbor's rank in the shared-field communicator
+    const SharedBuffer* buf_ = nullptr;
+    long seq_ = 0;
+
+    void spin_until(const std::atomic<long>& flag, long value) const;
+};
@@ -0,0 +1,224 @@
+#pragma once
+#include <string>
+
+#include "field.hpp"
+
+// Instruction-set levels for the stencil row kernels, ordered from least to most capable.
+enum class SimdLevel { Scalar, SSE2, AVX2, AVX512 };
+
+SimdLevel simd_from_string(const std::string& s);
+std::string simd_to_string(SimdLevel level);
+
+// Best level supported by the executing CPU (CPUID, including OS register-state support).
+SimdLevel detect_simd_level();
+
+// Resolves a `perf.simd` value ("auto" or a level name) to the level that will actually run:
+// "auto" picks the detected level, an explicit level is capped at what the CPU supports.
+SimdLevel resolve_simd_level(const std::string& requested);
+
+// Selects the row kernels used by diffusion_step, advection_step and advect_diffuse_step.
+// Defaults to the detected level until set explicitly.
+void set_simd_level(SimdLevel level);
+SimdLevel active_simd_level();
+
+// Row kernels over `count` consecutive cells. All pointers address the first cell of the span
+// and may be arbitrarily aligned; `s`/`c`/`n` are the south/centre/north rows of the stencil.
+struct RowKernels {
+    // out = c + ax * (c[+1] - 2c + c[-1]) + ay * (n - 2c + s)
+    void (*diffuse)(const double* s,
+                    const double* c,
+                    const double* n,
+                    double* out,
+                    int count,
+                    double ax,
+                    double ay);
+    // out -= cx * (xp - xm) + cy * (yp - ym)
+    void (*advect)(const double* xm,
+                   const double* xp,
+                   const double* ym,
+                   const double* yp,
+                   double* out,
+                   int count,
+                   double cx,
+                   double cy);
+    // out = c + diffuse(s, c, n) - cx * (c[ox] - c[ox - 1]) - cy * (yp - ym)
+    void (*advect_diffuse)(const double* s,
+                           const double* c,
+                           const double* n,
+                           const double* ym,
+                           const double* yp,
+                           int ox,
+                           double* out,
+                           int count,
+                           double ax,
+                           double ay,
+                           double cx,
+                           double cy);
+};
+
+const RowKernels& row_kernels(SimdLevel level);
+const RowKernels& row_kernels();
+
+// Enables flush-to-zero and denormals-are-zero on the calling thread; threads it starts later
+// (the OpenMP pool) inherit the mode. Single-precision fields underflow in the tails of a
+// diffusing profile within a few hundred steps, and every denormal operand costs a microcode
+// assist. No-op where the control register is not available.
+void set_flush_denormals(bool enable);
+
+// Portable row loops over storage type `T` with arithmetic in `Acc`; same expressions and order as
+// RowKernels. The <double, double> instantiations are the Scalar level of the dispatched kernels;
+// float and mixed precision (float storage, double arithmetic) always run these. `omp simd`
+// vectorizes them at the build's baseline ISA whether or not OpenMP threading is enabled.
+//
+// `sx` is the distance between x neighbours: 1, or the tracer count of an interleaved field, whose
+// rows are then swept as count * sx independent values.
+template <typename T, typename Acc>
+inline void diffuse_row(const T* FIELD_RESTRICT s,
+                        const T* FIELD_RESTRICT c,
+                        const T* FIELD_RESTRICT n,
+                        T* FIELD_RESTRICT out,
+                        int count,
+                        Acc ax,
+                        Acc ay,
+                        int sx = 1) {
+    const Acc two = 2;
+#pragma omp simd
+    for (int i = 0; i < count; ++i) {
+        const Acc uij = c[i];
+        out[i] = static_cast<T>(uij + ax * (Acc(c[i + sx]) - two * uij + Acc(c[i - sx])) +
+                                ay * (Acc(n[i]) - two * uij + Acc(s[i])));
+    }
+}
+
+template <typename T, typename Acc>
+inline void advect_row(const T* FIELD_RESTRICT xm,
+                       const T* FIELD_RESTRICT xp,
+                       const T* FIELD_RESTRICT ym,
+                       const T* FIELD_RESTRICT yp,
+                       T* FIELD_RESTRICT out,
+                       int count,
+                       Acc cx,
+                       Acc cy) {
+#pragma omp simd
+    for (int i = 0; i < count; ++i) {
+        const Acc g = cx * (Acc(xp[i]) - Acc(xm[i])) + cy * (Acc(yp[i]) - Acc(ym[i]));
+        out[i] = static_cast<T>(Acc(out[i]) - g);
+    }
+}
+
+template <typename T, typename Acc>
+inline void advect_diffuse_row(const T* FIELD_RESTRICT s,
+                               const T* FIELD_RESTRICT c,
+                               const T* FIELD_RESTRICT n,
+                               const T* FIELD_RESTRICT ym,
+                               const T* FIELD_RESTRICT yp,
+                               int ox,
+                               T* FIELD_RESTRICT out,
+                               int count,
+                               Acc ax,
+                               Acc ay,
+                               Acc cx,
+                               Acc cy,
+                               int sx = 1) {
+    const Acc two = 2;
+#pragma omp simd
+    for (int i = 0; i < count; ++i) {
+        const Acc uij = c[i];
+        const Acc diff = ax * (Acc(c[i + sx]) - two * uij + Acc(c[i - sx])) +
+                         ay * (Acc(n[i]) - two * uij + Acc(s[i]));
+        const Acc adv =
+            cx * (Acc(c[i + ox]) - Acc(c[i + ox - sx])) + cy * (Acc(yp[i]) - Acc(ym[i]));
+        out[i] = static_cast<T>(uij + diff - adv);
+    }
+}
+
+// Row operations the field kernels call, for storage `T` and arithmetic `Acc`. Double runs the
+// dispatched SIMD kernels; every other combination, and interleaved rows (sx > 1), run the
+// portable loops above. For advect_diffuse, `ox` is 0 or `sx`.
+template <typename T, typename Acc>
+struct RowOps {
+    void diffuse(const T* s,
+                 const T* c,
+                 const T* n,
+                 T* out,
+                 int count,
+                 double ax,
+                 double ay,
+                 int sx = 1) const {
+        diffuse_row<T, Acc>(s, c, n, out, count, Acc(ax), Acc(ay), sx);
+    }
+    void advect(const T* xm,
+                const T* xp,
+                const T* ym,
+                const T* yp,
+                T* out,
+                int count,
+                double cx,
+                double cy) const {
+        advect_row<T, Acc>(xm, xp, ym, yp, out, count, Acc(cx), Acc(cy));
+    }
+    void advect_diffuse(const T* s,
+                        const T* c,
+                        const T* n,
+                        const T* ym,
+                        const T* yp,
+                        int ox,
+                        T* out,
+                        int count,
+                        double ax,
+                        double ay,
+                        double cx,
+                        double cy,
+                        int sx = 1) const {
+        advect_diffuse_row<T, Acc>(
+            s, c, n, ym, yp, ox, out, count, Acc(ax), Acc(ay), Acc(cx), Acc(cy), sx);
+    }
+};
+
+template <>
+struct RowOps<double, double> {
+    RowKernels k = row_kernels();
+
+    void diffuse(const double* s,
+                 const double* c,
+                 const double* n,
+                 double* out,
+                 int count,
+                 double ax,
+                 double ay,
+                 int sx = 1) const {
+        if (sx == 1)
+            k.diffuse(s, c, n, out, count, ax, ay);
+        else
+            diffuse_row<double, double>(s, c, n, out, count, ax, ay, sx);
+    }
+    void advect(const double* xm,
+                const double* xp,
+                const double* ym,
+                const double* yp,
+                double* out,
+                int count,
+                double cx,
+                double cy) const {
+        k.advect(xm, xp, ym, yp, out, count, cx, cy);
+    }
+    void advect_diffuse(const double* s,
+                        const double* c,
+                        const double* n,
+                        const double* ym,
+                        const double* yp,
+                        int ox,
+                        double* out,
+                        int count,
+                        double ax,
+                        double ay,
+                        double cx,
+                        double cy,
+                        int sx = 1) const {
+        if (sx == 1)
+            k.advect_diffuse(s, c, n, ym, yp, ox, out, count, ax, ay, cx, cy);
+        else
+            advect_diffuse_row<double, double>(
+                s, c, n, ym, yp, ox, out, count, ax, ay, cx, cy, sx);
+    }
+};
@@ -1,16 +1,29 @@
 #pragma once
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
-inline double safe_dt(double dx, double dy, double vx, double vy, double D) {
+// Upwind advection CFL limit, C_x + C_y <= 1 (infinite without velocity).
+inline double advective_dt(double dx, double dy, double vx, double vy) {
     const double denom_adv =
         (std::abs(vx) > 0 ? std::abs(vx) / dx : 0.0) + (std::abs(vy) > 0 ? std::abs(vy) / dy : 0.0);
-    const double dt_adv =
-        (denom_adv > 0) ? (1.0 / denom_adv) : std::numeric_limits<double>::infinity();
+    return (denom_adv > 0) ? (1.0 / denom_adv) : std::numeric_limits<double>::infinity();
+}
 
+// FTCS diffusion limit, D * dt * (1/dx^2 + 1/dy^2) <= 1/2 (infinite without diffusion).
+inline double diffusive_dt(double dx, double dy, double D) {
     const double denom_diff = (1.0 / (dx * dx)) + (1.0 / (dy * dy));
-    const double dt_diff =
-        (D > 0) ? (1.0 / (2.0 * D * denom_diff)) : std::numeric_limits<double>::infinity();
+    return (D > 0) ? (1.0 / (2.0 * D * denom_diff)) : std::numeric_limits<double>::infinity();
+}
+
+inline double safe_dt(double dx, double dy, double vx, double vy, double D) {
+    return std::min(advective_dt(dx, dy, vx, vy), diffusive_dt(dx, dy, D));
+}
 
-    return std::min(dt_adv, dt_diff);
+// Substeps of `dt_sub` <= `dt_limit` covering a step of `dt`: ceil(dt / dt_limit), at least 1.
+// Ratios within rounding of an integer are not bumped to the next one.
+inline int substep_count(double dt, double dt_limit) {
+    if (!(dt_limit < std::numeric_limits<double>::infinity()))
+        return 1;
+    return std::max(1, static_cast<int>(std::ceil(dt / dt_limit * (1.0 - 1e-12))));
 }
@@ -0,0 +1,96 @@
+#pragma once
+#include <mpi.h>
+
+#include <memory>
+
+#include "decomp.hpp"
+#include "field.hpp"
+#include "halo.hpp"
+#include "implicit.hpp"
+#include "io.hpp"
+#include "profile.hpp"
+#include "sts.hpp"
+#include "subcycle.hpp"
+#include "tiling.hpp"
+
+// Per-phase wall time of BasicStepper::step (see Phase) plus event counts.
+struct StepTimings {
+    PhaseTimes phases;
+    long exchanges = 0;
+    long cg_iterations = 0;
+};
+
+// Advances the solution one explicit step at a time: halo exchange schedule, physical boundary
+// conditions and the advection-diffusion update.
+//
+// With `perf.halo_depth = k` the fields carry k ghost layers and halos are exchanged only every
+// k-th step (temporal blocking). Step s after an exchange updates the interior grown by k-1-s
+// cells into the ghost layers facing neighbor ranks, recomputing what the neighbors compute for
+// their own interior, so the last step before the next exchange needs no fresh ghosts.
+//
+// With `perf.overlap` (default) an exchanging step computes the cells whose stencil stays inside
+// the interior while the messages are in flight, then waits and finishes the strips next to the
+// ghosts.
+//
+// With `time.scheme = implicit` or `rkl2` the explicit update carries advection only and diffusion
+// is then applied to the new field with a backward-Euler solve (ImplicitDiffusion) or RKL2
+// super-time-stepping (Rkl2Diffusion). With `subcycle` the explicit update carries the non-stiff
+// term and Subcycler applies the stiff one in substeps. An update carrying advection only
+// exchanges just the upwind ghosts.
+//
+// `T` is the field storage type and `Acc` the kernel arithmetic type (see `precision`).
+template <typename T, typename Acc = T>
+class BasicStepper {
+   public:
+    BasicStepper(const SimConfig& cfg, const Decomp2D& dec, MPI_Comm comm);
+
+    // Ghost layers the fields passed to step() must be allocated with.
+    int halo() const { return depth_; }
+
+    // Advances `u` by one step; `tmp` is scratch of the same shape. The buffers are swapped.
+    void step(FieldT<T>& u, FieldT<T>& tmp);
+
+    // Step size of the following steps (adaptive dt); the same on every rank.
+    void set_dt(double dt);
+
+    // Call after the tiles of `dec` moved (LoadBalancer) and the fields were reallocated to the
+    // new shape: rebuilds the halo plan and the split solvers. Only between exchanges, i.e. when
+    // steps_taken() is a multiple of halo().
+    void reset_decomposition();
+
+    long steps_taken() const { return n_; }
+    const Subcycler<T, Acc>* subcycler() const { return subcycle_.get(); }
+    const StepTimings& timings() const { return timings_; }
+
+    // Halo bytes this rank has sent, including the exchanges of the split-off solvers.
+    long long halo_bytes() const;
+    // The part of halo_bytes() sent to neighbors on this rank's node.
+    long long halo_bytes_on_node() const;
+
+   private:
+    SimConfig cfg_;
+    const Decomp2D& dec_;
+    MPI_Comm comm_;
+    int depth_;
+    long n_ = 0;
+    StepTimings timings_;
+    // Sent through plans dropped by reset_decomposition().
+    long long retired_halo_bytes_ = 0, retired_halo_bytes_on_node_ = 0;
+    std::unique_ptr<HaloPlan> plan_;  // built on the first step, from the field's shape
+    std::unique_ptr<ImplicitDiffusion> implicit_;  // time.scheme=implicit with D > 0
+    std::unique_ptr<Rkl2Diffusion<T, Acc>> rkl2_;  // time.scheme=rkl2 with D > 0
+    std::unique_ptr<Subcycler<T, Acc>> subcycle_;  // time.scheme=subcycle
+    unsigned sides_ = kHaloAll;                    // ghosts the explicit update reads
+
+    void check_tile() const;
+    void make_solvers();
+    // True when diffusion is applied after the explicit update instead of inside it.
+    bool diffusion_split() const;
+    void update(const FieldT<T>& u, FieldT<T>& tmp, const Rect& region) const;
+};
+
+using Stepper = BasicStepper<double>;
+
+extern template class BasicStepper<double, double>;
+extern template class BasicStepper<float, float>;
+extern template class BasicStepper<float, double>;
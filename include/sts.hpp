@@ -0,0 +1,56 @@
+#pragma once
+#include <mpi.h>
+
+#include <vector>
+
+#include "boundary.hpp"
+#include "decomp.hpp"
+#include "field.hpp"
+#include "halo.hpp"
+#include "io.hpp"
+
+// Stages RKL2 needs for a diffusion step of `dt`: the smallest s >= 2 with
+// dt <= dt_diff * (s^2 + s - 2) / 4, where `dt_diff` is the forward-Euler limit (safe_dt).
+int rkl2_stages(double dt, double dt_diff);
+
+// Second-order Runge-Kutta-Legendre super-time-stepping (Meyer, Balsara & Aslam 2014) for the
+// diffusion term. A step of `dt` takes s explicit stages, each one halo exchange plus one sweep of
+// the diffusion row kernel and a linear combination with earlier stages. The stages are stable
+// for any s, so s follows from `dt` (rkl2_stages, recomputed by set_dt) and `dt` may be about
+// s^2 / 2 times the explicit limit.
+template <typename T, typename Acc = T>
+class Rkl2Diffusion {
+   public:
+    // The scratch fields share the shape and halo (`perf.halo_depth`) of the simulation fields.
+    Rkl2Diffusion(const SimConfig& cfg, const Decomp2D& dec, MPI_Comm comm);
+
+    int stages() const { return s_; }
+    long long halo_bytes() const { return plan_.bytes_sent(); }
+    long long halo_bytes_on_node() const { return plan_.bytes_sent_on_node(); }
+
+    // Changes the step of the next advance and recomputes the stage count for it.
+    void set_dt(double dt);
+
+    // Advances the interior of `u` by one diffusion step of `dt`. The result is swapped into
+    // `u.data`; ghosts are refreshed before every stage but stale afterwards.
+    void advance(FieldT<T>& u);
+
+   private:
+    const Decomp2D& dec_;
+    BCConfig bc_;
+    double kx_, ky_;  // D / dx^2, D / dy^2
+    double dt_diff_;  // forward-Euler diffusion limit
+    double ax_, ay_;  // kx * dt, ky * dt
+    int s_;
+    FieldT<T> m_;      // dt * L(Y0)
+    FieldT<T> a_, b_;  // stage buffers, alternating
+    HaloPlan plan_;
+    int row_;               // values in one interior row
+    std::vector<T> stage_;  // one row of Y + w1 dt L(Y) per thread, reused by every stage
+
+    void refresh_ghosts(FieldT<T>& f);
+};
+
+extern template class Rkl2Diffusion<double, double>;
+extern template class Rkl2Diffusion<float, float>;
+extern template class Rkl2Diffusion<float, double>;
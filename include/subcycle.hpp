@@ -0,0 +1,59 @@
+#pragma once
+#include <mpi.h>
+
+#include <string>
+
+#include "boundary.hpp"
+#include "decomp.hpp"
+#include "field.hpp"
+#include "halo.hpp"
+#include "io.hpp"
+
+// The term of the split step that is subcycled: the one with the smaller stability limit.
+enum class StiffTerm { Advection, Diffusion };
+
+std::string stiff_term_to_string(StiffTerm term);
+
+// Split of an outer step of `dt`: the stiff term and the substeps it takes, from the advective
+// and diffusive limits of stability.hpp. Diffusion counts as stiff on a tie.
+struct SubcycleSplit {
+    StiffTerm stiff;
+    int substeps;
+    double dt_adv, dt_diff;
+};
+
+SubcycleSplit subcycle_split(const SimConfig& cfg, double dt);
+
+// Multi-rate operator splitting (Lie): the stepper advances the non-stiff term once with the outer
+// dt, then Subcycler advances the stiff term in `substeps` explicit substeps of dt / substeps.
+// Each substep exchanges only the ghosts its stencil reads: all four sides for diffusion, the
+// upwind sides for advection.
+template <typename T, typename Acc = T>
+class Subcycler {
+   public:
+    Subcycler(const SimConfig& cfg, const Decomp2D& dec, MPI_Comm comm);
+
+    StiffTerm stiff() const { return split_.stiff; }
+    int substeps() const { return split_.substeps; }
+    long long halo_bytes() const { return plan_.bytes_sent(); }
+    long long halo_bytes_on_node() const { return plan_.bytes_sent_on_node(); }
+
+    // Changes the outer step and recomputes the substep count for it.
+    void set_dt(double dt);
+
+    // Advances the interior of `u` by the stiff term over one outer step. The result is swapped
+    // into `u.data`; ghosts are stale afterwards.
+    void advance(FieldT<T>& u);
+
+   private:
+    SimConfig cfg_;
+    const Decomp2D& dec_;
+    SubcycleSplit split_;
+    double dt_;
+    FieldT<T> tmp_;
+    HaloPlan plan_;
+};
+
+extern template class Subcycler<double, double>;
+extern template class Subcycler<float, float>;
+extern template class Subcycler<float, double>;
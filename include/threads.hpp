@@ -0,0 +1,16 @@
+#pragma once
+
+// Threads per MPI rank for the OpenMP loops (kernels, boundary fills, output packing). Without
+// OpenMP everything runs on the calling thread and these report 1.
+
+// Number of threads the next parallel loop will use.
+int max_threads();
+
+// Index of the calling thread within the current parallel region, 0 outside of one.
+int thread_num();
+
+// Sets the per-rank thread count; `n <= 0` keeps the OpenMP default (OMP_NUM_THREADS).
+void set_threads(int n);
+
+// Below this many cells a loop runs serially: forking a team costs more than it saves.
+constexpr long kMinParallelCells = 16384;
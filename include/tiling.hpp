@@ -0,0 +1,90 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "field.hpp"
+#include "threads.hpp"
+
+// Half-open index rectangle [i0, i1) x [j0, j1) in a Field's local (halo-inclusive) indices.
+struct Rect {
+    int i0 = 0, i1 = 0;
+    int j0 = 0, j1 = 0;
+
+    bool empty() const { return i0 >= i1 || j0 >= j1; }
+};
+
+template <typename T>
+inline Rect interior_rect(const FieldT<T>& f) {
+    return {f.halo, f.halo + f.nx_local, f.halo, f.halo + f.ny_local};
+}
+
+// `r` shrunk by `n` cells on every side (empty once it collapses).
+inline Rect shrink_rect(const Rect& r, int n) {
+    return {r.i0 + n, r.i1 - n, r.j0 + n, r.j1 - n};
+}
+
+// Cells of `outer` outside `inner` as up to four disjoint strips: bottom and top span the full
+// width, left and right the rows in between. `inner` must lie inside `outer` or be empty.
+inline std::array<Rect, 4> frame_rects(const Rect& outer, const Rect& inner) {
+    if (inner.empty())
+        return {outer, Rect{}, Rect{}, Rect{}};
+    return {Rect{outer.i0, outer.i1, outer.j0, inner.j0},
+            Rect{outer.i0, outer.i1, inner.j1, outer.j1},
+            Rect{outer.i0, inner.i0, inner.j0, inner.j1},
+            Rect{inner.i1, outer.i1, inner.j0, inner.j1}};
+}
+
+// Block sizes for the cache-blocked stencil traversal; 0 means "do not block along this axis".
+struct TileShape {
+    int tx = 0;
+    int ty = 0;
+};
+
+// L2 size of the executing core in bytes (sysconf / sysfs), or 1 MiB when it cannot be queried.
+size_t l2_cache_bytes();
+
+// Tile shape for an nx x ny interior of `elem_bytes`-sized values whose read and write tiles
+// together fill about half of L2. Blocks span full rows when possible so the SIMD row kernels
+// and the prefetcher see long unit-stride sweeps; x is only split for rows too wide to keep a few
+// of them in L2.
+TileShape default_tile_shape(int nx, int ny, size_t elem_bytes);
+
+// Resolves `perf.tile_x` / `perf.tile_y` (0 = derive from L2) for an nx x ny interior stored as
+// `elem_bytes`-sized values (precision_storage_bytes).
+TileShape resolve_tile_shape(int tile_x, int tile_y, int nx, int ny, size_t elem_bytes);
+
+// Tile shape used by the full-field kernels. Defaults to no blocking until set.
+void set_tile_shape(TileShape shape);
+TileShape active_tile_shape();
+
+// Calls fn(tile) for each block of `r`. Tiles are numbered row-major so consecutive tiles share
+// rows, and are split across the OpenMP threads in contiguous runs; when `shape` yields fewer
+// tiles than threads, rows are split further so every thread gets work. `fn` must only write
+// inside its tile.
+template <typename Fn>
+void for_each_tile(const Rect& r, TileShape shape, Fn&& fn) {
+    if (r.empty())
+        return;
+    const int w = r.i1 - r.i0;
+    const int hgt = r.j1 - r.j0;
+    const int tx = shape.tx > 0 ? std::min(shape.tx, w) : w;
+    int ty = shape.ty > 0 ? std::min(shape.ty, hgt) : hgt;
+    const int ntx = (w + tx - 1) / tx;
+
+    const long cells = static_cast<long>(w) * hgt;
+    const int threads = cells >= kMinParallelCells ? max_threads() : 1;
+    if (threads > 1 && ntx * ((hgt + ty - 1) / ty) < threads) {
+        const int bands = (threads + ntx - 1) / ntx;
+        ty = std::max(1, (hgt + bands - 1) / bands);
+    }
+    const int nty = (hgt + ty - 1) / ty;
+    const int ntiles = ntx * nty;
+
+#pragma omp parallel for schedule(static) if (threads > 1 && ntiles > 1)
+    for (int t = 0; t < ntiles; ++t) {
+        const int i = r.i0 + (t % ntx) * tx;
+        const int j = r.j0 + (t / ntx) * ty;
+        fn(Rect{i, std::min(i + tx, r.i1), j, std::min(j + ty, r.j1)});
+    }
+}
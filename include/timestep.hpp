@@ -0,0 +1,56 @@
+#pragma once
+#include <mpi.h>
+
+#include "io.hpp"
+
+// Largest stable dt on this rank's tile for `cfg.scheme`: the advection CFL, plus the FTCS
+// diffusion limit for the explicit scheme; the looser of the two for subcycling. Velocity and
+// diffusivity are uniform today, so every rank returns the same value; spatially varying
+// coefficients would enter here through the tile's own maxima.
+double local_dt_limit(const SimConfig& cfg);
+
+// Step size and simulation clock for the time loop.
+//
+// Fixed mode steps `cfg.dt` for `cfg.steps` steps and outputs every `out_every` steps. Adaptive
+// mode (`time.adaptive`) integrates to t_end = steps * dt with outputs at t = k * out_every * dt.
+// Every `time.dt_every` steps it takes one MPI_Allreduce(MIN) of local_dt_limit() and uses that
+// limit times `time.cfl`. Steps are shortened so the clock lands exactly on every output time
+// and on t_end: the stretch to the next target is split into equal steps under the limit.
+class TimeController {
+   public:
+    TimeController(const SimConfig& cfg, MPI_Comm comm);
+
+    double time() const { return t_; }
+    long steps_taken() const { return n_; }
+    bool done() const;
+
+    // True while the clock sits on an output time that has not been written yet.
+    bool output_due() const;
+    void output_written() { ++outputs_; }
+
+    // dt of the next step; collective in adaptive mode when the limit is refreshed.
+    double next_dt();
+    void advance(double dt);
+
+    double min_dt() const { return min_dt_; }
+    double max_dt() const { return max_dt_; }
+
+   private:
+    SimConfig cfg_;
+    MPI_Comm comm_;
+    bool adaptive_;
+    double dt_;          // fixed dt, or the nominal dt defining output times in adaptive mode
+    double cfl_;
+    int refresh_every_;
+    long steps_;
+    int out_every_;
+    double t_end_;
+    double t_ = 0.0;
+    long n_ = 0;
+    long outputs_ = 0;
+    double limit_ = 0.0;  // cfl * global stability limit, in adaptive mode
+    double min_dt_ = 0.0, max_dt_ = 0.0;
+
+    double output_time(long k) const { return static_cast<double>(k) * out_every_ * dt_; }
+    double next_target() const;
+};
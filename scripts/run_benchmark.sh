@@ -14,6 +14,19 @@ WEAK_TILE_NX="${WEAK_TILE_NX:-256}"
 WEAK_TILE_NY="${WEAK_TILE_NY:-256}"
 WEAK_RANKS="${WEAK_RANKS:-1 4 16}"
 
+# Hybrid runs: RANKS_PER_NODE ranks per node (e.g. one per NUMA domain), each with
+# THREADS_PER_RANK OpenMP threads pinned to its own cores. Unset = one single-threaded rank
+# per core, as before. The mapping flags are Open MPI's; override with MAP_FLAGS if needed.
+RANKS_PER_NODE="${RANKS_PER_NODE:-}"
+THREADS_PER_RANK="${THREADS_PER_RANK:-1}"
+MAP_FLAGS="${MAP_FLAGS:-}"
+if [ -n "${RANKS_PER_NODE}" ] && [ -z "${MAP_FLAGS}" ]; then
+  MAP_FLAGS="--map-by ppr:${RANKS_PER_NODE}:node:PE=${THREADS_PER_RANK} --bind-to core"
+fi
+export OMP_NUM_THREADS="${THREADS_PER_RANK}"
+export OMP_PROC_BIND="${OMP_PROC_BIND:-close}"
+export OMP_PLACES="${OMP_PLACES:-cores}"
+
 exe="${BUILD_DIR}/src/climate_sim"
 if [ ! -x "${exe}" ]; then
   echo "ERROR: ${exe} not found or not executable. Build first with CMake." >&2
@@ -31,8 +44,9 @@ strong_annot="${out_dir}/strong_annotated_${ts}.csv"
 run_and_parse() {
   local np=$1 nx=$2 ny=$3 steps=$4
   local line time perstep
-  line=$(${TIME_CMD} mpirun ${OVERSUB} -np "${np}" "${exe}" \
-    --nx="${nx}" --ny="${ny}" --steps="${steps}" | grep "timing:")
+  line=$(${TIME_CMD} mpirun ${OVERSUB} ${MAP_FLAGS} -np "${np}" "${exe}" \
+    --nx="${nx}" --ny="${ny}" --steps="${steps}" --perf.threads="${THREADS_PER_RANK}" \
+    | grep "timing:")
 
   time=$(echo "$line" | sed -E 's/.*total_max=([0-9.e+-]+).*/\1/')
   perstep=$(awk -v t="$time" -v s="$steps" 'BEGIN {printf "%.8f", t/s}')
@@ -42,7 +56,7 @@ run_and_parse() {
 # -------------------------
 # Strong scaling
 # -------------------------
-echo "# strong scaling: Nx=${STRONG_NX}, Ny=${STRONG_NY}, steps=${STEPS}" > "${strong_csv}"
+echo "# strong scaling: Nx=${STRONG_NX}, Ny=${STRONG_NY}, steps=${STEPS}, threads/rank=${THREADS_PER_RANK}" > "${strong_csv}"
 echo "ranks,nx,ny,steps,total_time,perstep_time" >> "${strong_csv}"
 
 for p in ${STRONG_RANKS}; do
@@ -74,7 +88,7 @@ fi
 # -------------------------
 # Weak scaling
 # -------------------------
-echo "# weak scaling: tile=${WEAK_TILE_NX}x${WEAK_TILE_NY}, steps=${STEPS}" > "${weak_csv}"
+echo "# weak scaling: tile=${WEAK_TILE_NX}x${WEAK_TILE_NY}, steps=${STEPS}, threads/rank=${THREADS_PER_RANK}" > "${weak_csv}"
 echo "ranks,nx,ny,steps,total_time,perstep_time" >> "${weak_csv}"
 
 for p in ${WEAK_RANKS}; do
@@ -0,0 +1,142 @@
+#include "advect_diffuse.hpp"
+
+#include "advection.hpp"
+#include "diffusion.hpp"
+#include "simd.hpp"
+
+namespace {
+
+// A dropped x component differences backward with cx = 0 and a dropped y component differences
+// the centre row with itself; both add exactly 0.
+template <typename T, typename Acc, int SX, int SY>
+void advect_diffuse_rect(const FieldT<T>& u,
+                         FieldT<T>& out,
+                         double ax,
+                         double ay,
+                         double cx,
+                         double cy,
+                         const Rect& r) {
+    const RowOps<T, Acc> k;
+    const int w = u.cell_width();
+    const int ox = SX < 0 ? w : 0;
+    const int i0 = r.i0 * w;
+    const int count = (r.i1 - r.i0) * w;
+    for (int p = 0; p < u.planes(); ++p) {
+        for (int j = r.j0; j < r.j1; ++j) {
+            const T* s = u.row(j - 1, p) + i0;
+            const T* c = u.row(j, p) + i0;
+            const T* n = u.row(j + 1, p) + i0;
+            k.advect_diffuse(s,
+                             c,
+                             n,
+                             SY > 0 ? s : c,
+                             SY < 0 ? n : c,
+                             ox,
+                             out.row(j, p) + i0,
+                             count,
+                             ax,
+                             ay,
+                             cx,
+                             cy,
+                             w);
+        }
+    }
+}
+
+// Diffusion and upwind coefficients of one sweep.
+struct Coefficients {
+    double ax, ay, cx, cy;
+};
+
+template <typename T>
+Coefficients coefficients(const FieldT<T>& u, double D, double vx, double vy, double dt) {
+    return {D * dt / (u.dx * u.dx), D * dt / (u.dy * u.dy), dt * vx / u.dx, dt * vy / u.dy};
+}
+
+}  // namespace
+
+template <typename T, typename Acc>
+AdvectDiffuseKernel<T> advect_diffuse_kernel(double vx, double vy) {
+    return with_upwind_signs(vx, vy, [](auto sx, auto sy) -> AdvectDiffuseKernel<T> {
+        return advect_diffuse_rect<T, Acc, decltype(sx)::value, decltype(sy)::value>;
+    });
+}
+
+template <typename T, typename Acc>
+void advect_diffuse_step(const FieldT<T>& u,
+                         FieldT<T>& out,
+                         double D,
+                         double vx,
+                         double vy,
+                         double dt,
+                         const Rect& r) {
+    const Coefficients k = coefficients(u, D, vx, vy, dt);
+    advect_diffuse_kernel<T, Acc>(vx, vy)(u, out, k.ax, k.ay, k.cx, k.cy, r);
+}
+
+template <typename T, typename Acc>
+void advect_diffuse_step(
+    const FieldT<T>& u, FieldT<T>& out, double D, double vx, double vy, double dt) {
+    explicit_update<T, Acc>(u, out, D, vx, vy, dt, true, interior_rect(u));
+    copy_halo_ring(u, out);
+}
+
+template <typename T, typename Acc>
+void diffuse_advect_blocked_step(
+    const FieldT<T>& u, FieldT<T>& out, double D, double vx, double vy, double dt) {
+    explicit_update<T, Acc>(u, out, D, vx, vy, dt, false, interior_rect(u));
+    copy_halo_ring(u, out);
+}
+
+template <typename T, typename Acc>
+void explicit_update(const FieldT<T>& u,
+                     FieldT<T>& out,
+                     double D,
+                     double vx,
+                     double vy,
+                     double dt,
+                     bool fused,
+                     const Rect& region) {
+    // Upwind directions are fixed for the sweep: pick the specialized kernels once.
+    const Coefficients k = coefficients(u, D, vx, vy, dt);
+    const AdvectDiffuseKernel<T> fused_kernel = advect_diffuse_kernel<T, Acc>(vx, vy);
+    const AdvectionKernel<T> advect_kernel = advection_kernel<T, Acc>(vx, vy);
+    for_each_tile(region, active_tile_shape(), [&](const Rect& t) {
+        if (fused) {
+            fused_kernel(u, out, k.ax, k.ay, k.cx, k.cy, t);
+        } else {
+            diffusion_step<T, Acc>(u, out, D, dt, t);
+            advect_kernel(u, out, k.cx, k.cy, t);
+        }
+    });
+}
+
+template AdvectDiffuseKernel<double> advect_diffuse_kernel<double, double>(double, double);
+template void advect_diffuse_step<double, double>(
+    const Field&, Field&, double, double, double, double);
+template void advect_diffuse_step<double, double>(
+    const Field&, Field&, double, double, double, double, const Rect&);
+template void diffuse_advect_blocked_step<double, double>(
+    const Field&, Field&, double, double, double, double);
+template void explicit_update<double, double>(
+    const Field&, Field&, double, double, double, double, bool, const Rect&);
+
+template AdvectDiffuseKernel<float> advect_diffuse_kernel<float, float>(double, double);
+template void advect_diffuse_step<float, float>(
+    const FieldF&, FieldF&, double, double, double, double);
+template void advect_diffuse_step<float, float>(
+    const FieldF&, FieldF&, double, double, double, double, const Rect&);
+template void diffuse_advect_blocked_step<float, float>(
+    const FieldF&, FieldF&, double, double, double, double);
+template void explicit_update<float, float>(
+    const FieldF&, FieldF&, double, double, double, double, bool, const Rect&);
+
+template AdvectDiffuseKernel<float> advect_diffuse_kernel<float, double>(double, double);
+template void advect_diffuse_step<float, double>(
+    const FieldF&, FieldF&, double, double, double, double);
+template void advect_diffuse_step<float, double>(
+    const FieldF&, FieldF&, double, double, double, double, const Rect&);
+template void diffuse_advect_blocked_step<float, double>(
+    const FieldF&, FieldF&, double, double, double, double);
+template void explicit_update<float, double>(
+    const FieldF&, FieldF&, double, double, double, double, bool, const Rect&);
@@ -0,0 +1,49 @@
+#include "allocator.hpp"
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstdlib>
+
+namespace {
+FieldLayout& active_layout() {
+    static FieldLayout layout{};
+    return layout;
+}
+
+constexpr size_t kHugePage = size_t{2} << 20;
+}  // namespace
+
+void set_field_layout(FieldLayout layout) { active_layout() = layout; }
+
+FieldLayout field_layout() { return active_layout(); }
+
+// Every block carries a one-line header holding the pointer to free. Huge-page blocks start at a
+// 2 MiB boundary, so two same-sized fields would map row for row onto the same cache sets (u is
+// read where tmp is written); successive huge blocks are shifted by a varying number of lines.
+void* field_alloc(size_t bytes, bool huge_pages) {
+    const bool huge = huge_pages && bytes >= kHugePage;
+    static std::atomic<unsigned> huge_count{0};
+    const size_t lead = huge ? kFieldAlignment * (1 + 9 * (huge_count++ % 16)) : kFieldAlignment;
+    size_t total = bytes + lead;
+    const size_t align = huge ? kHugePage : kFieldAlignment;
+    if (huge)
+        total = (total + kHugePage - 1) / kHugePage * kHugePage;
+
+    void* raw = nullptr;
+    if (posix_memalign(&raw, align, total) != 0)
+        throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    // Advisory only: without THP support the buffer simply stays on base pages.
+    if (huge)
+        madvise(raw, total, MADV_HUGEPAGE);
+#endif
+    char* p = static_cast<char*>(raw) + lead;
+    reinterpret_cast<void**>(p)[-1] = raw;
+    return p;
+}
+
+void field_free(void* p) noexcept {
+    if (p)
+        std::free(static_cast<void**>(p)[-1]);
+}
@@ -2,53 +2,101 @@
 
 #include <algorithm>
 
-static inline void fill_col(Field& f, int i, int j0, int j1, double v) {
-    for (int j = j0; j <= j1; ++j) f.at(i, j) = v;
+#include "threads.hpp"
+
+// Column fills touch one cell per row; they only fork threads for very tall tiles. All helpers
+// act on every tracer: each plane, and the cell_width() values of an interleaved cell.
+template <typename T>
+static inline void fill_col(FieldT<T>& f, int i, int j0, int j1, T v) {
+    const int w = f.cell_width();
+    for (int p = 0; p < f.planes(); ++p) {
+#pragma omp parallel for schedule(static) if (j1 - j0 >= kMinParallelCells)
+        for (int j = j0; j <= j1; ++j) std::fill_n(f.row(j, p) + i * w, w, v);
+    }
 }
-static inline void fill_row(Field& f, int j, int i0, int i1, double v) {
-    for (int i = i0; i <= i1; ++i) f.at(i, j) = v;
+template <typename T>
+static inline void fill_row(FieldT<T>& f, int j, int i0, int i1, T v) {
+    const int w = f.cell_width();
+    for (int p = 0; p < f.planes(); ++p) {
+        T* r = f.row(j, p);
+        std::fill(r + i0 * w, r + (i1 + 1) * w, v);
+    }
+}
+template <typename T>
+static inline void copy_col(FieldT<T>& f, int i_dst, int i_src, int j0, int j1) {
+    const int w = f.cell_width();
+    for (int p = 0; p < f.planes(); ++p) {
+#pragma omp parallel for schedule(static) if (j1 - j0 >= kMinParallelCells)
+        for (int j = j0; j <= j1; ++j) {
+            T* r = f.row(j, p);
+            std::copy_n(r + i_src * w, w, r + i_dst * w);
+        }
+    }
+}
+template <typename T>
+static inline void copy_row(FieldT<T>& f, int j_dst, int j_src, int i0, int i1) {
+    const int w = f.cell_width();
+    for (int p = 0; p < f.planes(); ++p) {
+        const T* src = f.row(j_src, p);
+        std::copy(src + i0 * w, src + (i1 + 1) * w, f.row(j_dst, p) + i0 * w);
+    }
 }
 
-void apply_boundary(Field& f, const Decomp2D& dec, const BCConfig& bc, double value = 0.0) {
+// Every ghost layer on a physical side gets the boundary value (Dirichlet) or the adjacent
+// interior value (Neumann), so deep halos see the same boundary as a single ghost layer.
+template <typename T>
+void apply_boundary(FieldT<T>& f, const Decomp2D& dec, const BCConfig& bc, double bc_value) {
+    const T value = static_cast<T>(bc_value);
     const int h = f.halo;
     const int nx = f.nx_local;
     const int ny = f.ny_local;
-    const int iL = 0;
-    const int iR = h + nx;
     const int jB = 0;
-    const int jT = h + ny;
+    const int jT = f.ny_total() - 1;
     const int i0 = 0;
     const int i1 = f.nx_total() - 1;
 
-    if (dec.nbr_lr[0] == MPI_PROC_NULL) {
-        if (bc.left == BCType::Dirichlet) {
-            fill_col(f, iL, jB, jT, value);
-        } else if (bc.left == BCType::Neumann) {
-            for (int j = jB; j <= jT; ++j) f.at(iL, j) = f.at(h, j);
+    for (int g = 0; g < h; ++g) {
+        const int iL = h - 1 - g;
+        const int iR = h + nx + g;
+
+        if (dec.nbr_lr[0] == MPI_PROC_NULL) {
+            if (bc.left == BCType::Dirichlet) {
+                fill_col(f, iL, jB, jT, value);
+            } else if (bc.left == BCType::Neumann) {
+                copy_col(f, iL, h, jB, jT);
+            }
         }
-    }
 
-    if (dec.nbr_lr[1] == MPI_PROC_NULL) {
-        if (bc.right == BCType::Dirichlet) {
-            fill_col(f, iR, jB, jT, value);
-        } else if (bc.right == BCType::Neumann) {
-            for (int j = jB; j <= jT; ++j) f.at(iR, j) = f.at(h + nx - 1, j);
+        if (dec.nbr_lr[1] == MPI_PROC_NULL) {
+            if (bc.right == BCType::Dirichlet) {
+                fill_col(f, iR, jB, jT, value);
+            } else if (bc.right == BCType::Neumann) {
+                copy_col(f, iR, h + nx - 1, jB, jT);
+            }
         }
     }
 
-    if (dec.nbr_du[0] == MPI_PROC_NULL) {
-        if (bc.bottom == BCType::Dirichlet) {
-            fill_row(f, jB, i0, i1, value);
-        } else if (bc.bottom == BCType::Neumann) {
-            for (int i = i0; i <= i1; ++i) f.at(i, jB) = f.at(i, h);
+    for (int g = 0; g < h; ++g) {
+        const int jBg = h - 1 - g;
+        const int jTg = h + ny + g;
+
+        if (dec.nbr_du[0] == MPI_PROC_NULL) {
+            if (bc.bottom == BCType::Dirichlet) {
+                fill_row(f, jBg, i0, i1, value);
+            } else if (bc.bottom == BCType::Neumann) {
+                copy_row(f, jBg, h, i0, i1);
+            }
         }
-    }
 
-    if (dec.nbr_du[1] == MPI_PROC_NULL) {
-        if (bc.top == BCType::Dirichlet) {
-            fill_row(f, jT, i0, i1, value);
-        } else if (bc.top == BCType::Neumann) {
-            for (int i = i0; i <= i1; ++i) f.at(i, jT) = f.at(i, h + ny - 1);
+        if (dec.nbr_du[1] == MPI_PROC_NULL) {
+            if (bc.top == BCType::Dirichlet) {
+                fill_row(f, jTg, i0, i1, value);
+            } else if (bc.top == BCType::Neumann) {
+                copy_row(f, jTg, h + ny - 1, i0, i1);
+            }
         }
     }
 }
+
+template void apply_boundary(Field&, const Decomp2D&, const BCConfig&, double);
+template void apply_boundary(FieldF&, const Decomp2D&, const BCConfig&, double);
@@ -2,35 +2,169 @@
 
 #include <mpi.h>
 
-void Decomp2D::init(MPI_Comm comm_world, int nxg, int nyg) {
-    nx_global = nxg;
-    ny_global = nyg;
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
 
-    int size = 0, world_rank = 0;
-    MPI_Comm_size(comm_world, &size);
-    MPI_Comm_rank(comm_world, &world_rank);
+namespace {
+
+// Node index of this rank, numbering the nodes in the order of their first ranks in `comm`.
+int node_index(MPI_Comm comm, int ranks_per_node) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+    if (ranks_per_node > 0)
+        return rank / ranks_per_node;
+    MPI_Comm shared, leaders;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &shared);
+    int local = 0, node = 0;
+    MPI_Comm_rank(shared, &local);
+    MPI_Comm_split(comm, local == 0 ? 0 : MPI_UNDEFINED, rank, &leaders);
+    if (leaders != MPI_COMM_NULL) {
+        MPI_Comm_rank(leaders, &node);
+        MPI_Comm_free(&leaders);
+    }
+    MPI_Bcast(&node, 1, MPI_INT, 0, shared);
+    MPI_Comm_free(&shared);
+    return node;
+}
+
+// Coordinates, neighbors, node placement and tiles of `d` once its cart_comm exists.
+void setup(Decomp2D& d, int nxg, int nyg, int my_node) {
+    d.nx_global = nxg;
+    d.ny_global = nyg;
+
+    int cart_rank = 0, size = 1;
+    MPI_Comm_rank(d.cart_comm, &cart_rank);
+    MPI_Comm_size(d.cart_comm, &size);
+    MPI_Cart_coords(d.cart_comm, cart_rank, 2, d.coords);
 
+    MPI_Cart_shift(d.cart_comm, 0, 1, &d.nbr_lr[0], &d.nbr_lr[1]);
+    MPI_Cart_shift(d.cart_comm, 1, 1, &d.nbr_du[0], &d.nbr_du[1]);
+
+    std::vector<int> node(size);
+    MPI_Allgather(&my_node, 1, MPI_INT, node.data(), 1, MPI_INT, d.cart_comm);
+    d.nodes = *std::max_element(node.begin(), node.end()) + 1;
+    for (int s = 0; s < 2; ++s) {
+        d.lr_on_node[s] = d.nbr_lr[s] != MPI_PROC_NULL && node[d.nbr_lr[s]] == my_node;
+        d.du_on_node[s] = d.nbr_du[s] != MPI_PROC_NULL && node[d.nbr_du[s]] == my_node;
+    }
+
+    const int base_nx = nxg / d.dims[0];
+    const int base_ny = nyg / d.dims[1];
+    const int rem_x = nxg % d.dims[0];
+    const int rem_y = nyg % d.dims[1];
+
+    d.nx_local = base_nx + (d.coords[0] == d.dims[0] - 1 ? rem_x : 0);
+    d.ny_local = base_ny + (d.coords[1] == d.dims[1] - 1 ? rem_y : 0);
+
+    d.x_offset = d.coords[0] * base_nx;
+    d.y_offset = d.coords[1] * base_ny;
+
+    d.x_cuts.resize(d.dims[0] + 1);
+    d.y_cuts.resize(d.dims[1] + 1);
+    for (int i = 0; i < d.dims[0]; ++i) d.x_cuts[i] = i * base_nx;
+    for (int j = 0; j < d.dims[1]; ++j) d.y_cuts[j] = j * base_ny;
+    d.x_cuts[d.dims[0]] = nxg;
+    d.y_cuts[d.dims[1]] = nyg;
+}
+
+}  // namespace
+
+NodeGrid choose_node_grid(int nodes, int per_node, int nx, int ny) {
+    NodeGrid best;
+    // Ordered by preference: grids without empty tiles, least inter-node surface, least total
+    // surface, dims[0] >= dims[1].
+    std::tuple<bool, long long, long long, bool> best_key;
+    bool found = false;
+    for (int nodes_x = 1; nodes_x <= nodes; ++nodes_x) {
+        if (nodes % nodes_x)
+            continue;
+        const int nodes_y = nodes / nodes_x;
+        for (int bx = 1; bx <= per_node; ++bx) {
+            if (per_node % bx)
+                continue;
+            const int by = per_node / bx;
+            const int px = nodes_x * bx, py = nodes_y * by;
+            const long long inter = 1LL * (nodes_x - 1) * ny + 1LL * (nodes_y - 1) * nx;
+            const long long total = 1LL * (px - 1) * ny + 1LL * (py - 1) * nx;
+            const auto key = std::make_tuple(px > nx || py > ny, inter, total, px < py);
+            if (!found || key < best_key) {
+                best = NodeGrid{{px, py}, {bx, by}};
+                best_key = key;
+                found = true;
+            }
+        }
+    }
+    return best;
+}
+
+void Decomp2D::init(MPI_Comm comm_world, int nxg, int nyg) {
+    int size = 0;
+    MPI_Comm_size(comm_world, &size);
+    dims[0] = dims[1] = 0;
     MPI_Dims_create(size, 2, dims);
     int periods[2] = {0, 0};
     MPI_Cart_create(comm_world, 2, dims, periods, 0, &cart_comm);
+    node_block[0] = node_block[1] = 0;
+    setup(*this, nxg, nyg, node_index(comm_world, 0));
+}
 
-    int cart_rank = 0;
-    MPI_Comm_rank(cart_comm, &cart_rank);
-    MPI_Cart_coords(cart_comm, cart_rank, 2, coords);
+void Decomp2D::init_node_aware(MPI_Comm comm_world, int nxg, int nyg, int ranks_per_node) {
+    int rank = 0, size = 0;
+    MPI_Comm_rank(comm_world, &rank);
+    MPI_Comm_size(comm_world, &size);
+    const int my_node = node_index(comm_world, ranks_per_node);
+    std::vector<int> node(size);
+    MPI_Allgather(&my_node, 1, MPI_INT, node.data(), 1, MPI_INT, comm_world);
+    const int n_nodes = *std::max_element(node.begin(), node.end()) + 1;
+    std::vector<int> count(n_nodes, 0);
+    for (int n : node) ++count[n];
+    const int per_node = count[0];
+    if (std::any_of(count.begin(), count.end(), [&](int c) { return c != per_node; })) {
+        init(comm_world, nxg, nyg);
+        return;
+    }
 
-    MPI_Cart_shift(cart_comm, 0, 1, &nbr_lr[0], &nbr_lr[1]);
-    MPI_Cart_shift(cart_comm, 1, 1, &nbr_du[0], &nbr_du[1]);
+    const NodeGrid g = choose_node_grid(n_nodes, per_node, nxg, nyg);
+    const int nodes_x = g.dims[0] / g.block[0];
+    const int local = static_cast<int>(std::count(node.begin(), node.begin() + rank, my_node));
+    const int cx = (my_node % nodes_x) * g.block[0] + local % g.block[0];
+    const int cy = (my_node / nodes_x) * g.block[1] + local / g.block[0];
 
-    const int base_nx = nx_global / dims[0];
-    const int base_ny = ny_global / dims[1];
-    const int rem_x = nx_global % dims[0];
-    const int rem_y = ny_global % dims[1];
+    // MPI_Cart_create numbers the grid row-major (rank = cx * dims[1] + cy) and, without
+    // reordering, keeps the order of its input communicator, so that order is set first.
+    MPI_Comm ordered;
+    MPI_Comm_split(comm_world, 0, cx * g.dims[1] + cy, &ordered);
+    dims[0] = g.dims[0];
+    dims[1] = g.dims[1];
+    int periods[2] = {0, 0};
+    MPI_Cart_create(ordered, 2, dims, periods, 0, &cart_comm);
+    MPI_Comm_free(&ordered);
+    node_block[0] = g.block[0];
+    node_block[1] = g.block[1];
+    setup(*this, nxg, nyg, my_node);
+}
 
-    nx_local = base_nx + (coords[0] == dims[0] - 1 ? rem_x : 0);
-    ny_local = base_ny + (coords[1] == dims[1] - 1 ? rem_y : 0);
+static void check_cuts(const std::vector<int>& c, int parts, int n, const char* axis) {
+    bool ok = static_cast<int>(c.size()) == parts + 1 && c.front() == 0 && c.back() == n;
+    for (size_t i = 1; ok && i < c.size(); ++i) ok = c[i] > c[i - 1];
+    if (!ok)
+        throw std::runtime_error(std::string("Decomp2D: invalid ") + axis + " cuts for " +
+                                 std::to_string(parts) + " tiles over " + std::to_string(n) +
+                                 " cells");
+}
 
-    x_offset = coords[0] * base_nx;
-    y_offset = coords[1] * base_ny;
+void Decomp2D::set_cuts(const std::vector<int>& xc, const std::vector<int>& yc) {
+    check_cuts(xc, dims[0], nx_global, "x");
+    check_cuts(yc, dims[1], ny_global, "y");
+    x_cuts = xc;
+    y_cuts = yc;
+    x_offset = x_cuts[coords[0]];
+    y_offset = y_cuts[coords[1]];
+    nx_local = x_cuts[coords[0] + 1] - x_offset;
+    ny_local = y_cuts[coords[1] + 1] - y_offset;
 }
 
 void Decomp2D::finalize() {
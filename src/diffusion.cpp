@@ -1,26 +1,57 @@
 #include "diffusion.hpp"
 
-void diffusion_step(const Field& u, Field& out, double D, double dt) {
-    const double dx = u.dx;
-    const double dy = u.dy;
-    const double ax = D * dt / (dx * dx);
-    const double ay = D * dt / (dy * dy);
-
-    for (int j = u.halo; j < u.ny_local + u.halo; ++j) {
-        for (int i = u.halo; i < u.nx_local + u.halo; ++i) {
-            const double uij = u.at(i, j);
-            const double lap = (u.at(i + 1, j) - 2.0 * uij + u.at(i - 1, j)) / (dx * dx) +
-                               (u.at(i, j + 1) - 2.0 * uij + u.at(i, j - 1)) / (dy * dy);
-            out.at(i, j) = uij + dt * D * lap;
+#include <algorithm>
+
+#include "simd.hpp"
+
+template <typename T, typename Acc>
+void diffusion_step(const FieldT<T>& u, FieldT<T>& out, double D, double dt, const Rect& r) {
+    const double ax = D * dt / (u.dx * u.dx);
+    const double ay = D * dt / (u.dy * u.dy);
+
+    const RowOps<T, Acc> k;
+    const int w = u.cell_width();
+    const int i0 = r.i0 * w;
+    const int count = (r.i1 - r.i0) * w;
+    for (int p = 0; p < u.planes(); ++p) {
+        for (int j = r.j0; j < r.j1; ++j) {
+            k.diffuse(u.row(j - 1, p) + i0,
+                      u.row(j, p) + i0,
+                      u.row(j + 1, p) + i0,
+                      out.row(j, p) + i0,
+                      count,
+                      ax,
+                      ay,
+                      w);
         }
     }
+}
 
-    for (int i = 0; i < u.nx_total(); ++i) {
-        out.at(i, 0) = u.at(i, 0);
-        out.at(i, u.ny_total() - 1) = u.at(i, u.ny_total() - 1);
-    }
-    for (int j = 0; j < u.ny_total(); ++j) {
-        out.at(0, j) = u.at(0, j);
-        out.at(u.nx_total() - 1, j) = u.at(u.nx_total() - 1, j);
+template <typename T, typename Acc>
+void diffusion_step(const FieldT<T>& u, FieldT<T>& out, double D, double dt) {
+    const int w = u.cell_width();
+    const int nx_tot = u.nx_total() * w;
+    const int ny_tot = u.ny_total();
+
+    for_each_tile(interior_rect(u), active_tile_shape(), [&](const Rect& t) {
+        diffusion_step<T, Acc>(u, out, D, dt, t);
+    });
+
+    for (int p = 0; p < u.planes(); ++p) {
+        std::copy(u.row(0, p), u.row(0, p) + nx_tot, out.row(0, p));
+        std::copy(u.row(ny_tot - 1, p), u.row(ny_tot - 1, p) + nx_tot, out.row(ny_tot - 1, p));
+        for (int j = 0; j < ny_tot; ++j) {
+            const T* src = u.row(j, p);
+            T* dst = out.row(j, p);
+            std::copy(src, src + w, dst);
+            std::copy(src + nx_tot - w, src + nx_tot, dst + nx_tot - w);
+        }
     }
 }
+
+template void diffusion_step<double, double>(const Field&, Field&, double, double);
+template void diffusion_step<float, float>(const FieldF&, FieldF&, double, double);
+template void diffusion_step<float, double>(const FieldF&, FieldF&, double, double);
+template void diffusion_step<double, double>(const Field&, Field&, double, double, const Rect&);
+template void diffusion_step<float, float>(const FieldF&, FieldF&, double, double, const Rect&);
+template void diffusion_step<float, double>(const FieldF&, FieldF&, double, double, const Rect&);
@@ -3,13 +3,56 @@
 #include <algorithm>
 #include <stdexcept>
 
-Field::Field(int nx, int ny, int h, double dx_, double dy_)
+#include "threads.hpp"
+
+namespace {
+template <typename T>
+constexpr int kLineElems = static_cast<int>(kFieldAlignment / sizeof(T));
+
+int row_pitch(int nx_tot, int line, const FieldLayout& layout) {
+    return layout.pad_rows ? (nx_tot + line - 1) / line * line : nx_tot;
+}
+
+// Leading elements that put column `h` of every row on a cache-line boundary.
+size_t row_origin(int h, int line, const FieldLayout& layout) {
+    return layout.pad_rows ? static_cast<size_t>((line - h % line) % line) : 0;
+}
+}  // namespace
+
+template <typename T>
+FieldT<T>::FieldT(int nx, int ny, int h, double dx_, double dy_)
+    : FieldT(nx, ny, h, dx_, dy_, Tracers{}, field_layout()) {}
+
+template <typename T>
+FieldT<T>::FieldT(int nx, int ny, int h, double dx_, double dy_, const FieldLayout& layout)
+    : FieldT(nx, ny, h, dx_, dy_, Tracers{}, layout) {}
+
+template <typename T>
+FieldT<T>::FieldT(int nx, int ny, int h, double dx_, double dy_, const Tracers& tracers)
+    : FieldT(nx, ny, h, dx_, dy_, tracers, field_layout()) {}
+
+template <typename T>
+FieldT<T>::FieldT(int nx,
+                  int ny,
+                  int h,
+                  double dx_,
+                  double dy_,
+                  const Tracers& tracers,
+                  const FieldLayout& layout)
     : nx_local(nx),
       ny_local(ny),
       halo(h),
       dx(dx_),
       dy(dy_),
-      data(static_cast<size_t>((nx + 2 * h) * (ny + 2 * h)), 0.0) {}
+      tracer(tracers),
+      pitch(row_pitch((nx + 2 * h) * cell_width(), kLineElems<T>, layout)),
+      plane(static_cast<size_t>(pitch) * (ny + 2 * h)),
+      origin(row_origin(h * cell_width(), kLineElems<T>, layout)),
+      data(origin + plane * planes(), FieldAllocator<T>(layout.huge_pages, layout.shared)) {
+    if (tracers.count < 1)
+        throw std::invalid_argument("Field needs at least one tracer");
+    fill(T(0));
+}
 
 inline static void check_bounds(int i, int j, int nx_tot, int ny_tot) {
     if (i < 0 || j < 0 || i >= nx_tot || j >= ny_tot) {
@@ -17,15 +60,65 @@ inline static void check_bounds(int i, int j, int nx_tot, int ny_tot) {
     }
 }
 
-size_t Field::idx(int i, int j) const {
+template <typename T>
+size_t FieldT<T>::idx(int i, int j, int k) const {
     const int nx_tot = nx_total();
     const int ny_tot = ny_total();
     check_bounds(i, j, nx_tot, ny_tot);
-    return static_cast<size_t>(j) * nx_tot + i;
+    if (k < 0 || k >= tracers())
+        throw std::out_of_range("Field tracer index out of range");
+    const int w = cell_width();
+    const size_t p = interleaved() ? 0 : static_cast<size_t>(k);
+    return origin + p * plane + static_cast<size_t>(j) * pitch + i * w + (interleaved() ? k : 0);
 }
 
-double& Field::at(int i, int j) { return data.at(idx(i, j)); }
+template <typename T>
+T& FieldT<T>::at(int i, int j, int k) {
+    return data.at(idx(i, j, k));
+}
+
+template <typename T>
+const T& FieldT<T>::at(int i, int j, int k) const {
+    return data.at(idx(i, j, k));
+}
 
-const double& Field::at(int i, int j) const { return data.at(idx(i, j)); }
+template <typename T>
+void FieldT<T>::fill(T value) {
+    // Static row bands, like for_each_tile over full-row tiles: on first touch each band's pages
+    // land on the NUMA node of the thread that computes it.
+    // Tracer planes are stacked row blocks, so they are filled as one tall plane.
+    const int ny_tot = ny_total() * planes();
+    T* base = data.data();
+    std::fill(base, base + origin, value);
+#pragma omp parallel for schedule(static) if (1L * pitch * ny_tot >= kMinParallelCells)
+    for (int j = 0; j < ny_tot; ++j) {
+        T* r = base + origin + static_cast<size_t>(j) * pitch;
+        std::fill(r, r + pitch, value);
+    }
+}
+
+template <typename T>
+void copy_halo_ring(const FieldT<T>& src, FieldT<T>& dst) {
+    const int w = src.cell_width();
+    const int h = src.halo * w;
+    const int nx_tot = src.nx_total() * w;
+    const int ny_tot = src.ny_total();
+
+    for (int p = 0; p < src.planes(); ++p) {
+        for (int j = 0; j < ny_tot; ++j) {
+            const T* s = src.row(j, p);
+            T* d = dst.row(j, p);
+            if (j < src.halo || j >= ny_tot - src.halo) {
+                std::copy(s, s + nx_tot, d);
+            } else {
+                std::copy(s, s + h, d);
+                std::copy(s + nx_tot - h, s + nx_tot, d + nx_tot - h);
+            }
+        }
+    }
+}
 
-void Field::fill(double value) { std::fill(data.begin(), data.end(), value); }
+template struct FieldT<double>;
+template struct FieldT<float>;
+template void copy_halo_ring(const FieldT<double>&, FieldT<double>&);
+template void copy_halo_ring(const FieldT<float>&, FieldT<float>&);
@@ -1,50 +1,563 @@
 #include "halo.hpp"
 
-#include <array>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <stdexcept>
+#include <utility>
 
-void exchange_halos(Field& f, const Decomp2D& dec, MPI_Comm comm) {
-    const int h = f.halo;
-    const int nx = f.nx_local;
-    const int ny = f.ny_local;
+namespace {
+template <typename T>
+MPI_Datatype mpi_type();
+template <>
+MPI_Datatype mpi_type<double>() {
+    return MPI_DOUBLE;
+}
+template <>
+MPI_Datatype mpi_type<float>() {
+    return MPI_FLOAT;
+}
+
+// `plane_type` repeated over `planes` tracer planes `stride` bytes apart, committed. One message
+// then carries every tracer.
+MPI_Datatype over_planes(MPI_Datatype plane_type, int planes, MPI_Aint stride) {
+    MPI_Datatype t = plane_type;
+    if (planes > 1) {
+        MPI_Type_create_hvector(planes, 1, stride, plane_type, &t);
+        MPI_Type_free(&plane_type);
+    }
+    MPI_Type_commit(&t);
+    return t;
+}
+
+HaloBackend& active_backend() {
+    static HaloBackend backend = HaloBackend::P2P;
+    return backend;
+}
+
+// Side bit of the ghosts neighbor s (0 = left, 1 = right, 2 = down, 3 = up) fills.
+constexpr unsigned kSideBit[4] = {kHaloLeft, kHaloRight, kHaloDown, kHaloUp};
+}  // namespace
+
+HaloBackend halo_backend_from_string(const std::string& s) {
+    std::string t = s;
+    std::transform(t.begin(), t.end(), t.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (t == "p2p")
+        return HaloBackend::P2P;
+    if (t == "shm")
+        return HaloBackend::Shm;
+    if (t == "rma")
+        return HaloBackend::Rma;
+    if (t == "neighbor")
+        return HaloBackend::Neighbor;
+    throw std::runtime_error("Unknown halo backend: " + s + " (expected p2p|shm|rma|neighbor)");
+}
+
+std::string halo_backend_to_string(HaloBackend b) {
+    switch (b) {
+        case HaloBackend::P2P:
+            return "p2p";
+        case HaloBackend::Shm:
+            return "shm";
+        case HaloBackend::Rma:
+            return "rma";
+        case HaloBackend::Neighbor:
+            return "neighbor";
+    }
+    return "p2p";
+}
+
+void set_halo_backend(HaloBackend b) { active_backend() = b; }
+
+HaloBackend halo_backend() { return active_backend(); }
+
+template <typename T>
+HaloPlan::HaloPlan(const FieldT<T>& f, const Decomp2D& dec, MPI_Comm comm)
+    : nx_(f.nx_local),
+      ny_(f.ny_local),
+      h_(f.halo),
+      pitch_(f.pitch),
+      tracers_(f.tracers()),
+      interleaved_(f.interleaved()),
+      left_(dec.nbr_lr[0]),
+      right_(dec.nbr_lr[1]),
+      down_(dec.nbr_du[0]),
+      up_(dec.nbr_du[1]),
+      comm_(comm),
+      elem_(mpi_type<T>()),
+      backend_(halo_backend()) {
+    const int w = f.cell_width();
     const int nx_tot = f.nx_total();
 
-    MPI_Datatype colType;
-    MPI_Type_vector(ny, 1, nx_tot, MPI_DOUBLE, &colType);
-    MPI_Type_commit(&colType);
+    // Columns are h cells wide over the interior rows; rows are h full-width rows, so they carry
+    // the corner ghosts once the column phase has filled them. Both stride by the row pitch, so
+    // row padding is never sent. Interleaved tracers widen every cell; separate tracer planes
+    // repeat the block once per plane, so each neighbor still gets a single message.
+    //
+    // With a single layer the rma and neighbor backends move rows and columns in one epoch or
+    // collective, so the rows must not touch the corner ghosts the column messages are writing:
+    // they span the interior columns only (row_x0_ onwards), which is all the 5-point stencil
+    // reads.
+    if (h_ == 1 && (backend_ == HaloBackend::Rma || backend_ == HaloBackend::Neighbor))
+        row_x0_ = h_;
+    const int row_cells = row_x0_ > 0 ? nx_ : nx_tot;
+    const MPI_Aint plane_bytes = static_cast<MPI_Aint>(f.plane * sizeof(T));
+    MPI_Datatype col, row;
+    MPI_Type_vector(ny_, h_ * w, pitch_, elem_, &col);
+    MPI_Type_vector(h_, row_cells * w, pitch_, elem_, &row);
+    colType_ = over_planes(col, f.planes(), plane_bytes);
+    rowType_ = over_planes(row, f.planes(), plane_bytes);
+    MPI_Type_size(colType_, &col_bytes_);
+    MPI_Type_size(rowType_, &row_bytes_);
+
+    on_node_ = (dec.lr_on_node[0] ? kHaloLeft : 0u) | (dec.lr_on_node[1] ? kHaloRight : 0u) |
+               (dec.du_on_node[0] ? kHaloDown : 0u) | (dec.du_on_node[1] ? kHaloUp : 0u);
+    cell_bytes_ = w * static_cast<int>(sizeof(T));
+    if (backend_ == HaloBackend::Rma)
+        init_rma(f);
+    if (backend_ == HaloBackend::Neighbor)
+        init_graph(f);
+    if (backend_ == HaloBackend::Shm) {
+        ShmGeometry g;
+        g.origin = static_cast<long long>(f.origin * sizeof(T));
+        g.pitch = static_cast<long long>(f.pitch) * sizeof(T);
+        g.plane = static_cast<long long>(plane_bytes);
+        g.nx_local = nx_;
+        g.ny_local = ny_;
+        const int nbrs[4] = {left_, right_, down_, up_};
+        shm_ = std::make_unique<ShmLinks>(comm, nbrs, g);
+        for (int s = 0; s < 4; ++s)
+            if (shm_->linked(s))
+                linked_ |= kSideBit[s];
+    }
+}
+
+HaloPlan::~HaloPlan() {
+    // Plans owned by objects that outlive MPI_Finalize (e.g. locals in main) just let go.
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (finalized)
+        return;
+    for (Requests& r : bound_) {
+        for (MPI_Request& q : r.cols) MPI_Request_free(&q);
+        for (MPI_Request& q : r.rows) MPI_Request_free(&q);
+        if (r.win != MPI_WIN_NULL)
+            MPI_Win_free(&r.win);
+    }
+    for (MPI_Datatype& t : put_type_)
+        if (t != MPI_DATATYPE_NULL)
+            MPI_Type_free(&t);
+    if (nbr_group_ != MPI_GROUP_NULL)
+        MPI_Group_free(&nbr_group_);
+    if (graph_ != MPI_COMM_NULL)
+        MPI_Comm_free(&graph_);
+    MPI_Type_free(&colType_);
+    MPI_Type_free(&rowType_);
+}
+
+// The neighbors' buffers may be laid out differently (tile widths differ by the remainder or the
+// rebalanced cuts, which changes the pitch), so every rank first learns each neighbor's layout.
+template <typename T>
+void HaloPlan::init_rma(const FieldT<T>& f) {
+    const int nbrs[4] = {left_, right_, down_, up_};
+    ShmGeometry mine, theirs[4];
+    mine.origin = static_cast<long long>(f.origin * sizeof(T));
+    mine.pitch = static_cast<long long>(f.pitch) * sizeof(T);
+    mine.plane = static_cast<long long>(f.plane * sizeof(T));
+    mine.nx_local = nx_;
+    mine.ny_local = ny_;
+    // Tagged by the side the receiver sees the sender on.
+    constexpr int kOpposite[4] = {1, 0, 3, 2};
+    MPI_Request reqs[8];
+    int n = 0;
+    for (int s = 0; s < 4; ++s) {
+        if (nbrs[s] == MPI_PROC_NULL)
+            continue;
+        MPI_Irecv(&theirs[s], sizeof(ShmGeometry), MPI_BYTE, nbrs[s], 300 + s, comm_, &reqs[n++]);
+        MPI_Isend(&mine, sizeof(ShmGeometry), MPI_BYTE, nbrs[s], 300 + kOpposite[s], comm_,
+                  &reqs[n++]);
+    }
+    MPI_Waitall(n, reqs, MPI_STATUSES_IGNORE);
+
+    auto at = [&](const ShmGeometry& g, int i, int j) {
+        return static_cast<MPI_Aint>(g.origin + j * g.pitch + 1LL * i * cell_bytes_);
+    };
+    const int w = f.cell_width();
+    std::vector<int> group;
+    for (int s = 0; s < 4; ++s) {
+        if (nbrs[s] == MPI_PROC_NULL)
+            continue;
+        const ShmGeometry& g = theirs[s];
+        MPI_Datatype t;
+        if (s < 2) {
+            // My outermost interior columns into the facing ghost columns of the neighbor.
+            put_src_[s] = at(mine, s == 0 ? h_ : nx_, h_);
+            put_dst_[s] = at(g, s == 0 ? h_ + g.nx_local : 0, h_);
+            MPI_Type_create_hvector(g.ny_local, h_ * w, g.pitch, elem_, &t);
+        } else {
+            const int cells = row_x0_ > 0 ? g.nx_local : g.nx_local + 2 * h_;
+            put_src_[s] = at(mine, row_x0_, s == 2 ? h_ : ny_);
+            put_dst_[s] = at(g, row_x0_, s == 2 ? h_ + g.ny_local : 0);
+            MPI_Type_create_hvector(h_, cells * w, g.pitch, elem_, &t);
+        }
+        put_type_[s] = over_planes(t, f.planes(), g.plane);
+        if (std::find(group.begin(), group.end(), nbrs[s]) == group.end())
+            group.push_back(nbrs[s]);
+    }
+    MPI_Group world;
+    MPI_Comm_group(comm_, &world);
+    MPI_Group_incl(world, static_cast<int>(group.size()), group.data(), &nbr_group_);
+    MPI_Group_free(&world);
+}
+
+// Receives come from the neighbors in the order left, right, down, up; sends go to right, left,
+// up, down.
+template <typename T>
+void HaloPlan::init_graph(const FieldT<T>& f) {
+    auto at = [&](int i, int j) {
+        return static_cast<MPI_Aint>((f.origin + static_cast<size_t>(j) * f.pitch +
+                                      static_cast<size_t>(i) * f.cell_width()) *
+                                     sizeof(T));
+    };
+    auto add = [](Edges& e, std::vector<int>& ranks, int nbr, MPI_Aint disp, MPI_Datatype type,
+                  unsigned side) {
+        if (nbr == MPI_PROC_NULL)
+            return;
+        ranks.push_back(nbr);
+        e.displs.push_back(disp);
+        e.types.push_back(type);
+        e.sides.push_back(side);
+    };
+    const int h = h_;
+    std::vector<int> sources, dests;
+    add(recv_edges_, sources, left_, at(0, h), colType_, kHaloLeft);
+    add(recv_edges_, sources, right_, at(h + nx_, h), colType_, kHaloRight);
+    add(recv_edges_, sources, down_, at(row_x0_, 0), rowType_, kHaloDown);
+    add(recv_edges_, sources, up_, at(row_x0_, h + ny_), rowType_, kHaloUp);
+    add(send_edges_, dests, right_, at(nx_, h), colType_, kHaloLeft);
+    add(send_edges_, dests, left_, at(h, h), colType_, kHaloRight);
+    add(send_edges_, dests, up_, at(row_x0_, ny_), rowType_, kHaloDown);
+    add(send_edges_, dests, down_, at(row_x0_, h), rowType_, kHaloUp);
+    recv_edges_.counts.assign(sources.size(), 0);
+    send_edges_.counts.assign(dests.size(), 0);
+    recv_edges_.addrs.assign(sources.size(), 0);
+    send_edges_.addrs.assign(dests.size(), 0);
+
+    MPI_Dist_graph_create_adjacent(comm_, static_cast<int>(sources.size()), sources.data(),
+                                   MPI_UNWEIGHTED, static_cast<int>(dests.size()), dests.data(),
+                                   MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &graph_);
+}
+
+template <typename T>
+HaloPlan::Requests& HaloPlan::requests_for(FieldT<T>& f) {
+    if (f.nx_local != nx_ || f.ny_local != ny_ || f.halo != h_ || f.pitch != pitch_ ||
+        f.tracers() != tracers_ || f.interleaved() != interleaved_ || mpi_type<T>() != elem_)
+        throw std::runtime_error("HaloPlan: field shape differs from the plan's");
+
+    // Persistent requests are bound to a buffer address. Steppers swap two buffers every step, so
+    // each one gets its own request set on first use.
+    const void* base = f.data.data();
+    const SharedBuffer* shared = shm_ ? find_shared_buffer(base) : nullptr;
+    for (auto it = bound_.begin(); it != bound_.end(); ++it) {
+        if (it->base != base)
+            continue;
+        if (it->shared == shared)
+            return *it;
+        // The buffer was freed and another one allocated at its address: start over.
+        for (MPI_Request& q : it->cols) MPI_Request_free(&q);
+        for (MPI_Request& q : it->rows) MPI_Request_free(&q);
+        if (it->win != MPI_WIN_NULL)
+            MPI_Win_free(&it->win);
+        bound_.erase(it);
+        break;
+    }
+
+    Requests r;
+    r.base = base;
+    // Neighbors linked through shared memory read this buffer's strips themselves.
+    r.shared = shared;
+    unsigned skip = shared ? linked_ : 0u;
+    if (backend_ == HaloBackend::Rma) {
+        // Only PSCW epochs are used on it, so the library can skip its lock machinery.
+        MPI_Info info;
+        MPI_Info_create(&info);
+        MPI_Info_set(info, "no_locks", "true");
+        MPI_Win_create(f.data.data(), static_cast<MPI_Aint>(f.data.size() * sizeof(T)), 1, info,
+                       comm_, &r.win);
+        MPI_Info_free(&info);
+        skip = kHaloAll;
+    }
+    if (backend_ == HaloBackend::Neighbor)
+        skip = kHaloAll;
+    const int h = h_;
+    // A receive from a neighbor fills the ghosts on its side; the matching send feeds the
+    // neighbor's ghosts on the opposite side.
+    auto add = [](std::vector<MPI_Request>& reqs, std::vector<unsigned>& tags, unsigned side) {
+        reqs.emplace_back();
+        tags.push_back(side);
+        return &reqs.back();
+    };
+    if (left_ != MPI_PROC_NULL && !(skip & kHaloLeft)) {
+        MPI_Recv_init(
+            &f.at(0, h), 1, colType_, left_, 100, comm_, add(r.cols, r.col_sides, kHaloLeft));
+        MPI_Send_init(
+            &f.at(h, h), 1, colType_, left_, 101, comm_, add(r.cols, r.col_sides, kHaloRight));
+    }
+    if (right_ != MPI_PROC_NULL && !(skip & kHaloRight)) {
+        MPI_Recv_init(&f.at(h + nx_, h),
+                      1,
+                      colType_,
+                      right_,
+                      101,
+                      comm_,
+                      add(r.cols, r.col_sides, kHaloRight));
+        MPI_Send_init(
+            &f.at(nx_, h), 1, colType_, right_, 100, comm_, add(r.cols, r.col_sides, kHaloLeft));
+    }
+    if (down_ != MPI_PROC_NULL && !(skip & kHaloDown)) {
+        MPI_Recv_init(
+            &f.at(0, 0), 1, rowType_, down_, 200, comm_, add(r.rows, r.row_sides, kHaloDown));
+        MPI_Send_init(
+            &f.at(0, h), 1, rowType_, down_, 201, comm_, add(r.rows, r.row_sides, kHaloUp));
+    }
+    if (up_ != MPI_PROC_NULL && !(skip & kHaloUp)) {
+        MPI_Recv_init(
+            &f.at(0, h + ny_), 1, rowType_, up_, 201, comm_, add(r.rows, r.row_sides, kHaloUp));
+        MPI_Send_init(
+            &f.at(0, ny_), 1, rowType_, up_, 200, comm_, add(r.rows, r.row_sides, kHaloDown));
+    }
+    bound_.push_back(std::move(r));
+    return bound_.back();
+}
+
+// Starts the requests serving `sides`. Requests left inactive complete at once in wait().
+static void start(std::vector<MPI_Request>& reqs,
+                  const std::vector<unsigned>& tags,
+                  unsigned sides) {
+    if (reqs.empty())
+        return;
+    if (sides == kHaloAll) {
+        MPI_Startall(static_cast<int>(reqs.size()), reqs.data());
+        return;
+    }
+    for (size_t k = 0; k < reqs.size(); ++k)
+        if (tags[k] & sides)
+            MPI_Start(&reqs[k]);
+}
+
+static void wait(std::vector<MPI_Request>& reqs) {
+    if (!reqs.empty())
+        MPI_Waitall(static_cast<int>(reqs.size()), reqs.data(), MPI_STATUSES_IGNORE);
+}
+
+template <typename T>
+void HaloPlan::begin(FieldT<T>& f, unsigned sides) {
+    if (active_)
+        throw std::runtime_error("HaloPlan::begin: previous exchange not completed");
+    active_ = &requests_for(f);
+    sides_ = sides;
+    const unsigned skip = active_->shared ? linked_ : 0u;
+    bytes_sent_ += message_bytes(sides, skip);
+    bytes_sent_on_node_ += message_bytes(sides, skip | (kHaloAll & ~on_node_));
+    if (active_->shared)
+        shm_->post_ready(active_->shared);
 
-    MPI_Datatype rowType;
-    MPI_Type_contiguous(nx_tot, MPI_DOUBLE, &rowType);
-    MPI_Type_commit(&rowType);
+    // A single ghost layer only feeds the 5-point stencil, which never reads corners, so both
+    // directions go out together. Deeper halos are read diagonally by the temporally blocked
+    // steps and need the corners, so the rows are started once the columns have arrived.
+    if (active_->win != MPI_WIN_NULL) {
+        open_epoch();
+        put_strips(false);
+        if (h_ == 1)
+            put_strips(true);
+        return;
+    }
+    if (graph_ != MPI_COMM_NULL) {
+        start_alltoallw(h_ > 1 ? kHaloLeft | kHaloRight : kHaloAll);
+        return;
+    }
+    start(active_->cols, active_->col_sides, sides_);
+    if (h_ == 1)
+        start(active_->rows, active_->row_sides, sides_);
+}
 
-    std::array<MPI_Request, 8> req{};
-    int rcount = 0;
+void HaloPlan::end() {
+    if (!active_)
+        throw std::runtime_error("HaloPlan::end: no exchange in progress");
 
-    const int left = dec.nbr_lr[0];
-    const int right = dec.nbr_lr[1];
-    const int down = dec.nbr_du[0];
-    const int up = dec.nbr_du[1];
+    if (graph_ != MPI_COMM_NULL) {
+        MPI_Wait(&coll_, MPI_STATUS_IGNORE);
+        if (h_ > 1) {
+            start_alltoallw(kHaloDown | kHaloUp);
+            MPI_Wait(&coll_, MPI_STATUS_IGNORE);
+        }
+        active_ = nullptr;
+        return;
+    }
+    if (active_->win != MPI_WIN_NULL) {
+        close_epoch();
+        if (h_ > 1) {
+            open_epoch();
+            put_strips(true);
+            close_epoch();
+        }
+        active_ = nullptr;
+        return;
+    }
+
+    wait(active_->cols);
+    if (active_->shared)
+        copy_shared_columns();
+    if (h_ > 1) {
+        if (active_->shared)
+            shm_->post(ShmLinks::Columns);
+        start(active_->rows, active_->row_sides, sides_);
+    }
+    if (active_->shared)
+        copy_shared_rows();
+    wait(active_->rows);
+    if (active_->shared)
+        shm_->finish();
+    active_ = nullptr;
+}
 
-    if (left != MPI_PROC_NULL) {
-        MPI_Irecv(&f.at(0, h), 1, colType, left, 100, comm, &req[rcount++]);
-        MPI_Isend(&f.at(h, h), 1, colType, left, 101, comm, &req[rcount++]);
+// One collective over the requested sides within `phase`; edges outside it carry nothing. Sends
+// read interior strips and receives fill ghost strips of the same buffer; the strips of one
+// phase never overlap (single-layer rows skip the corners, deeper rows go in their own phase).
+// MPI does not allow one buffer as both sendbuf and recvbuf, so every edge is addressed
+// absolutely from MPI_BOTTOM.
+void HaloPlan::start_alltoallw(unsigned phase) {
+    MPI_Aint base;
+    MPI_Get_address(active_->base, &base);
+    for (Edges* e : {&recv_edges_, &send_edges_}) {
+        for (size_t k = 0; k < e->sides.size(); ++k) {
+            e->counts[k] = (e->sides[k] & phase & sides_) ? 1 : 0;
+            e->addrs[k] = MPI_Aint_add(base, e->displs[k]);
+        }
     }
-    if (right != MPI_PROC_NULL) {
-        MPI_Irecv(&f.at(h + nx, h), 1, colType, right, 101, comm, &req[rcount++]);
-        MPI_Isend(&f.at(h + nx - 1, h), 1, colType, right, 100, comm, &req[rcount++]);
+    MPI_Ineighbor_alltoallw(MPI_BOTTOM, send_edges_.counts.data(), send_edges_.addrs.data(),
+                            send_edges_.types.data(), MPI_BOTTOM, recv_edges_.counts.data(),
+                            recv_edges_.addrs.data(), recv_edges_.types.data(), graph_, &coll_);
+}
+
+// The neighbors put into this rank's ghosts (exposure) while it puts into theirs (access).
+void HaloPlan::open_epoch() {
+    MPI_Win_post(nbr_group_, 0, active_->win);
+    MPI_Win_start(nbr_group_, 0, active_->win);
+}
+
+// Returns once this rank's puts are done and every neighbor's puts into its ghosts have landed.
+void HaloPlan::close_epoch() {
+    MPI_Win_complete(active_->win);
+    MPI_Win_wait(active_->win);
+}
+
+void HaloPlan::put_strips(bool rows) {
+    const int nbrs[4] = {left_, right_, down_, up_};
+    // The put to side s fills the neighbor's ghosts on the side facing this rank.
+    constexpr unsigned kFills[4] = {kHaloRight, kHaloLeft, kHaloUp, kHaloDown};
+    const char* base = static_cast<const char*>(active_->base);
+    for (int s = rows ? 2 : 0; s < (rows ? 4 : 2); ++s) {
+        if (nbrs[s] == MPI_PROC_NULL || !(sides_ & kFills[s]))
+            continue;
+        MPI_Put(base + put_src_[s], 1, rows ? rowType_ : colType_, nbrs[s], put_dst_[s], 1,
+                put_type_[s], active_->win);
     }
-    if (down != MPI_PROC_NULL) {
-        MPI_Irecv(&f.at(0, 0), 1, rowType, down, 200, comm, &req[rcount++]);
-        MPI_Isend(&f.at(0, h), 1, rowType, down, 201, comm, &req[rcount++]);
+}
+
+long long HaloPlan::message_bytes(unsigned sides, unsigned skip) const {
+    // The send to a neighbor fills its ghosts on the side facing this rank; linked neighbors in
+    // `skip` read them from shared memory instead.
+    auto sends = [&](int nbr, unsigned nbr_side, unsigned fills) {
+        return nbr != MPI_PROC_NULL && !(skip & nbr_side) && (sides & fills);
+    };
+    long long b = 0;
+    b += sends(left_, kHaloLeft, kHaloRight) ? col_bytes_ : 0;
+    b += sends(right_, kHaloRight, kHaloLeft) ? col_bytes_ : 0;
+    b += sends(down_, kHaloDown, kHaloUp) ? row_bytes_ : 0;
+    b += sends(up_, kHaloUp, kHaloDown) ? row_bytes_ : 0;
+    return b;
+}
+
+long long HaloPlan::send_bytes(unsigned sides) const { return message_bytes(sides, linked_); }
+
+// Copies `rows` rows of `len` bytes per tracer plane from the neighbor buffer `src` (row src_j,
+// byte column src_x) into this rank's active buffer (row dst_j, byte column dst_x).
+void HaloPlan::copy_strip(const char* src,
+                          const ShmGeometry& from,
+                          long long src_x,
+                          int src_j,
+                          long long dst_x,
+                          int dst_j,
+                          int rows,
+                          size_t len) {
+    char* dst = static_cast<char*>(const_cast<void*>(active_->base));
+    const ShmGeometry& to = shm_->own_geometry();
+    const int planes = interleaved_ ? 1 : tracers_;
+    for (int p = 0; p < planes; ++p)
+        for (int r = 0; r < rows; ++r)
+            std::memcpy(dst + to.origin + p * to.plane + (dst_j + r) * to.pitch + dst_x,
+                        src + from.origin + p * from.plane + (src_j + r) * from.pitch + src_x,
+                        len);
+}
+
+// Ghost columns from on-node neighbors: their outermost h interior columns.
+void HaloPlan::copy_shared_columns() {
+    const long long cell = cell_bytes_;
+    const size_t len = static_cast<size_t>(h_) * cell_bytes_;
+    for (int s = 0; s < 2; ++s) {
+        if (!(linked_ & sides_ & kSideBit[s]))
+            continue;
+        const char* nbr = shm_->wait(s, ShmLinks::Ready);
+        const ShmGeometry& g = shm_->geometry(s);
+        const long long src_x = (s == 0 ? g.nx_local : h_) * cell;
+        const long long dst_x = (s == 0 ? 0 : h_ + nx_) * cell;
+        copy_strip(nbr, g, src_x, h_, dst_x, h_, ny_, len);
     }
-    if (up != MPI_PROC_NULL) {
-        MPI_Irecv(&f.at(0, h + ny), 1, rowType, up, 201, comm, &req[rcount++]);
-        MPI_Isend(&f.at(0, h + ny - 1), 1, rowType, up, 200, comm, &req[rcount++]);
+}
+
+// Ghost rows from on-node neighbors. Deep halos take full-width rows, corners included, once the
+// neighbor has filled its ghost columns; a single layer only needs the interior columns.
+void HaloPlan::copy_shared_rows() {
+    const bool corners = h_ > 1;
+    const long long x0 = corners ? 0 : static_cast<long long>(h_) * cell_bytes_;
+    const size_t len = static_cast<size_t>(corners ? nx_ + 2 * h_ : nx_) * cell_bytes_;
+    for (int s = 2; s < 4; ++s) {
+        if (!(linked_ & sides_ & kSideBit[s]))
+            continue;
+        const char* nbr = shm_->wait(s, corners ? ShmLinks::Columns : ShmLinks::Ready);
+        const ShmGeometry& g = shm_->geometry(s);
+        const int src_j = s == 2 ? g.ny_local : h_;
+        const int dst_j = s == 2 ? 0 : h_ + ny_;
+        copy_strip(nbr, g, x0, src_j, x0, dst_j, h_, len);
     }
+}
 
-    if (rcount)
-        MPI_Waitall(rcount, req.data(), MPI_STATUSES_IGNORE);
+template <typename T>
+void exchange_halos(FieldT<T>& f, const Decomp2D& dec, MPI_Comm comm) {
+    HaloPlan plan(f, dec, comm);
+    plan.exchange(f);
+}
 
-    MPI_Type_free(&colType);
-    MPI_Type_free(&rowType);
+template <typename T>
+Rect expanded_interior(const FieldT<T>& f, const Decomp2D& dec, int e) {
+    Rect r = interior_rect(f);
+    if (dec.nbr_lr[0] != MPI_PROC_NULL)
+        r.i0 -= e;
+    if (dec.nbr_lr[1] != MPI_PROC_NULL)
+        r.i1 += e;
+    if (dec.nbr_du[0] != MPI_PROC_NULL)
+        r.j0 -= e;
+    if (dec.nbr_du[1] != MPI_PROC_NULL)
+        r.j1 += e;
+    return r;
 }
+
+template HaloPlan::HaloPlan(const Field&, const Decomp2D&, MPI_Comm);
+template HaloPlan::HaloPlan(const FieldF&, const Decomp2D&, MPI_Comm);
+template void HaloPlan::begin(Field&, unsigned);
+template void HaloPlan::begin(FieldF&, unsigned);
+template void exchange_halos(Field&, const Decomp2D&, MPI_Comm);
+template void exchange_halos(FieldF&, const Decomp2D&, MPI_Comm);
+template Rect expanded_interior(const Field&, const Decomp2D&, int);
+template Rect expanded_interior(const FieldF&, const Decomp2D&, int);
@@ -0,0 +1,180 @@
+#include "implicit.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "threads.hpp"
+
+namespace {
+
+// Runs `row(j)` for the interior rows j = 1..ny, in parallel when the tile is large enough.
+template <typename F>
+void for_rows(int ny, [[maybe_unused]] long cells, F&& row) {
+#pragma omp parallel for schedule(static) if (cells >= kMinParallelCells)
+    for (int j = 1; j <= ny; ++j) row(j);
+}
+
+// Sums `row(j)` over the interior rows. Rows run in parallel but are added in row order, so the
+// result is the same for every thread count.
+template <typename F>
+double sum_rows(std::vector<double>& partial, long cells, F&& row) {
+    const int ny = static_cast<int>(partial.size());
+    for_rows(ny, cells, [&](int j) { partial[j - 1] = row(j); });
+    double s = 0.0;
+    for (double v : partial) s += v;
+    return s;
+}
+
+}  // namespace
+
+ImplicitDiffusion::ImplicitDiffusion(const SimConfig& cfg, const Decomp2D& dec, MPI_Comm comm)
+    : dec_(dec),
+      comm_(comm),
+      bc_(cfg.bc),
+      kx_(cfg.D / (cfg.dx * cfg.dx)),
+      ky_(cfg.D / (cfg.dy * cfg.dy)),
+      ax_(kx_ * cfg.dt),
+      ay_(ky_ * cfg.dt),
+      tol_(cfg.cg_tol),
+      max_iter_(cfg.cg_max_iter),
+      x_(dec.nx_local, dec.ny_local, 1, cfg.dx, cfg.dy),
+      d_(dec.nx_local, dec.ny_local, 1, cfg.dx, cfg.dy),
+      r_(dec.nx_local, dec.ny_local, 1, cfg.dx, cfg.dy),
+      p_(dec.nx_local, dec.ny_local, 1, cfg.dx, cfg.dy),
+      q_(dec.nx_local, dec.ny_local, 1, cfg.dx, cfg.dy),
+      partial_(dec.ny_local),
+      plan_(p_, dec, comm) {}
+
+void ImplicitDiffusion::set_dt(double dt) {
+    ax_ = kx_ * dt;
+    ay_ = ky_ * dt;
+}
+
+void ImplicitDiffusion::refresh_ghosts(Field& f) {
+    plan_.exchange(f);
+    apply_boundary(f, dec_, bc_, 0.0);
+}
+
+double ImplicitDiffusion::allreduce(double local) const {
+    double global = 0.0;
+    MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_SUM, comm_);
+    return global;
+}
+
+template <typename T>
+int ImplicitDiffusion::solve(FieldT<T>& u) {
+    const int nx = u.nx_local, ny = u.ny_local;
+    const int h = u.halo;
+    const long cells = static_cast<long>(nx) * ny;
+    const double ax = ax_, ay = ay_;
+
+    // x = u, p = u + d (the previous increment as the initial guess).
+    const double xx_local = sum_rows(partial_, cells, [&](int j) {
+        const T* src = u.row(h - 1 + j) + h;
+        double* x = x_.row(j) + 1;
+        const double* d = d_.row(j) + 1;
+        double* p = p_.row(j) + 1;
+        double s = 0.0;
+#pragma omp simd reduction(+ : s)
+        for (int i = 0; i < nx; ++i) {
+            x[i] = static_cast<double>(src[i]);
+            p[i] = x[i] + d[i];
+            s += x[i] * x[i];
+        }
+        return s;
+    });
+    const double x_norm = std::sqrt(allreduce(xx_local));
+    if (x_norm == 0.0) {
+        d_.fill(0.0);  // the exact solution is u = 0
+        return 0;
+    }
+    const double stop = tol_ * x_norm;
+
+    // r = b - A d = dt D lap(u + d) - d
+    refresh_ghosts(p_);
+    double rr = allreduce(sum_rows(partial_, cells, [&](int j) {
+        const double* s = p_.row(j - 1) + 1;
+        const double* c = p_.row(j) + 1;
+        const double* n = p_.row(j + 1) + 1;
+        const double* d = d_.row(j) + 1;
+        double* r = r_.row(j) + 1;
+        double acc = 0.0;
+#pragma omp simd reduction(+ : acc)
+        for (int i = 0; i < nx; ++i) {
+            r[i] = ax * (c[i + 1] - 2.0 * c[i] + c[i - 1]) + ay * (n[i] - 2.0 * c[i] + s[i]) -
+                   d[i];
+            acc += r[i] * r[i];
+        }
+        return acc;
+    }));
+    for_rows(ny, cells, [&](int j) {
+        const double* r = r_.row(j) + 1;
+        std::copy(r, r + nx, p_.row(j) + 1);
+    });
+
+    int it = 0;
+    while (std::sqrt(rr) > stop) {
+        if (it == max_iter_) {
+            throw std::runtime_error("implicit diffusion: CG did not converge in " +
+                                     std::to_string(max_iter_) + " iterations (residual " +
+                                     std::to_string(std::sqrt(rr) / x_norm) +
+                                     " relative); raise time.cg_max_iter or lower dt");
+        }
+        ++it;
+
+        // q = A p = p - dt D lap(p)
+        refresh_ghosts(p_);
+        const double pq = allreduce(sum_rows(partial_, cells, [&](int j) {
+            const double* s = p_.row(j - 1) + 1;
+            const double* c = p_.row(j) + 1;
+            const double* n = p_.row(j + 1) + 1;
+            double* q = q_.row(j) + 1;
+            double acc = 0.0;
+#pragma omp simd reduction(+ : acc)
+            for (int i = 0; i < nx; ++i) {
+                q[i] = c[i] - ax * (c[i + 1] - 2.0 * c[i] + c[i - 1]) -
+                       ay * (n[i] - 2.0 * c[i] + s[i]);
+                acc += c[i] * q[i];
+            }
+            return acc;
+        }));
+
+        const double alpha = rr / pq;
+        const double rr_next = allreduce(sum_rows(partial_, cells, [&](int j) {
+            const double* p = p_.row(j) + 1;
+            const double* q = q_.row(j) + 1;
+            double* d = d_.row(j) + 1;
+            double* r = r_.row(j) + 1;
+            double acc = 0.0;
+#pragma omp simd reduction(+ : acc)
+            for (int i = 0; i < nx; ++i) {
+                d[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+                acc += r[i] * r[i];
+            }
+            return acc;
+        }));
+
+        const double beta = rr_next / rr;
+        rr = rr_next;
+        for_rows(ny, cells, [&](int j) {
+            const double* r = r_.row(j) + 1;
+            double* p = p_.row(j) + 1;
+            for (int i = 0; i < nx; ++i) p[i] = r[i] + beta * p[i];
+        });
+    }
+
+    for_rows(ny, cells, [&](int j) {
+        const double* x = x_.row(j) + 1;
+        const double* d = d_.row(j) + 1;
+        T* dst = u.row(h - 1 + j) + h;
+        for (int i = 0; i < nx; ++i) dst[i] = static_cast<T>(x[i] + d[i]);
+    });
+    iterations_ += it;
+    return it;
+}
+
+template int ImplicitDiffusion::solve(Field&);
+template int ImplicitDiffusion::solve(FieldF&);
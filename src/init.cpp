@@ -9,7 +9,8 @@
 #include <string>
 #include <vector>
 
-static void ic_gaussian(const Decomp2D& dec, Field& u, const SimConfig& cfg) {
+template <typename T>
+static void ic_gaussian(const Decomp2D& dec, FieldT<T>& u, const SimConfig& cfg) {
     const int h = u.halo;
     const int nx = u.nx_local;
     const int ny = u.ny_local;
@@ -20,19 +21,25 @@ static void ic_gaussian(const Decomp2D& dec, Field& u, const SimConfig& cfg) {
     const double yc = cfg.ic.yc_frac * Ly;
     const double sig = cfg.ic.sigma_frac * std::min(Lx, Ly);
 
-    for (int j = h; j < h + ny; ++j) {
-        const int gj = dec.y_offset + (j - h);
-        const double y = (gj + 0.5) * cfg.dy;
-        for (int i = h; i < h + nx; ++i) {
-            const int gi = dec.x_offset + (i - h);
-            const double x = (gi + 0.5) * cfg.dx;
-            const double r2 = (x - xc) * (x - xc) + (y - yc) * (y - yc);
-            u.at(i, j) = cfg.ic.A * std::exp(-r2 / (2.0 * sig * sig));
+    const int w = u.cell_width();
+    for (int k = 0; k < u.tracers(); ++k) {
+        const double A = cfg.ic.A / (k + 1);
+        for (int j = h; j < h + ny; ++j) {
+            const int gj = dec.y_offset + (j - h);
+            const double y = (gj + 0.5) * cfg.dy;
+            T* r = u.interleaved() ? u.row(j) + k : u.row(j, k);
+            for (int i = h; i < h + nx; ++i) {
+                const int gi = dec.x_offset + (i - h);
+                const double x = (gi + 0.5) * cfg.dx;
+                const double r2 = (x - xc) * (x - xc) + (y - yc) * (y - yc);
+                r[i * w] = static_cast<T>(A * std::exp(-r2 / (2.0 * sig * sig)));
+            }
         }
     }
 }
 
-void apply_initial_condition(const Decomp2D& dec, Field& u, const SimConfig& cfg) {
+template <typename T>
+void apply_initial_condition(const Decomp2D& dec, FieldT<T>& u, const SimConfig& cfg) {
     if (cfg.ic.mode == "preset") {
         if (cfg.ic.preset == "gaussian_hotspot") {
             ic_gaussian(dec, u, cfg);
@@ -45,3 +52,6 @@ void apply_initial_condition(const Decomp2D& dec, Field& u, const SimConfig& cfg
         throw std::runtime_error("IC mode 'file' not supported in PnetCDF build.");
     }
 }
+
+template void apply_initial_condition(const Decomp2D&, Field&, const SimConfig&);
+template void apply_initial_condition(const Decomp2D&, FieldF&, const SimConfig&);
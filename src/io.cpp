@@ -12,9 +12,13 @@
 #include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 
 #include "boundary.hpp"
 #include "field.hpp"
+#include "halo.hpp"
+#include "simd.hpp"
+#include "threads.hpp"
 namespace fs = std::filesystem;
 
 namespace {
@@ -55,6 +59,76 @@ std::string bc_to_string(BCType bc) {
     return "dirichlet";
 }
 
+Precision precision_from_string(const std::string& s) {
+    auto t = lower(s);
+    if (t == "double" || t == "fp64")
+        return Precision::Double;
+    if (t == "float" || t == "single" || t == "fp32")
+        return Precision::Float;
+    if (t == "mixed")
+        return Precision::Mixed;
+    throw std::runtime_error("Unknown precision: " + s + " (expected float|double|mixed)");
+}
+
+std::string precision_to_string(Precision p) {
+    switch (p) {
+        case Precision::Double:
+            return "double";
+        case Precision::Float:
+            return "float";
+        case Precision::Mixed:
+            return "mixed";
+    }
+    return "double";
+}
+
+size_t precision_storage_bytes(Precision p) {
+    return p == Precision::Double ? sizeof(double) : sizeof(float);
+}
+
+TimeScheme scheme_from_string(const std::string& s) {
+    auto t = lower(s);
+    if (t == "explicit")
+        return TimeScheme::Explicit;
+    if (t == "implicit")
+        return TimeScheme::Implicit;
+    if (t == "rkl2" || t == "sts")
+        return TimeScheme::Rkl2;
+    if (t == "subcycle" || t == "split")
+        return TimeScheme::Subcycle;
+    throw std::runtime_error("Unknown time scheme: " + s +
+                             " (expected explicit|implicit|rkl2|subcycle)");
+}
+
+std::string scheme_to_string(TimeScheme s) {
+    switch (s) {
+        case TimeScheme::Explicit:
+            return "explicit";
+        case TimeScheme::Implicit:
+            return "implicit";
+        case TimeScheme::Rkl2:
+            return "rkl2";
+        case TimeScheme::Subcycle:
+            return "subcycle";
+    }
+    return "explicit";
+}
+
+TracerLayout tracer_layout_from_string(const std::string& s) {
+    auto t = lower(s);
+    if (t == "planes" || t == "soa")
+        return TracerLayout::Planes;
+    if (t == "interleaved" || t == "aos")
+        return TracerLayout::Interleaved;
+    throw std::runtime_error("Unknown tracer layout: " + s + " (expected planes|interleaved)");
+}
+
+std::string tracer_layout_to_string(TracerLayout layout) {
+    return layout == TracerLayout::Interleaved ? "interleaved" : "planes";
+}
+
+std::string tracer_var_name(int k) { return k == 0 ? "u" : "u_" + std::to_string(k); }
+
 void SimConfig::validate() const {
     if (nx <= 0 || ny <= 0)
         throw std::runtime_error("nx/ny must be > 0");
@@ -66,6 +140,39 @@ void SimConfig::validate() const {
         throw std::runtime_error("steps must be > 0");
     if (out_every < 1)
         throw std::runtime_error("out_every must be >= 1");
+    if (perf.simd != "auto")
+        (void)simd_from_string(perf.simd);
+    if (perf.tile_x < 0 || perf.tile_y < 0)
+        throw std::runtime_error("perf.tile_x/tile_y must be >= 0 (0 = derive from L2)");
+    if (perf.halo_depth < 1)
+        throw std::runtime_error("perf.halo_depth must be >= 1");
+    (void)halo_backend_from_string(perf.halo_backend);
+    if (perf.threads < 0)
+        throw std::runtime_error("perf.threads must be >= 0 (0 = OpenMP default)");
+    if (decomp.rebalance_every < 0 || decomp.rebalance_tol < 0)
+        throw std::runtime_error("decomp.rebalance_every and decomp.rebalance_tol must be >= 0");
+    if (decomp.ranks_per_node < 0)
+        throw std::runtime_error("decomp.ranks_per_node must be >= 0 (0 = detect)");
+    if (decomp.rebalance_every % perf.halo_depth != 0)
+        throw std::runtime_error("decomp.rebalance_every must be a multiple of perf.halo_depth");
+    if (cfl <= 0 || cfl > 1)
+        throw std::runtime_error("time.cfl must be in (0, 1]");
+    if (dt_every < 1)
+        throw std::runtime_error("time.dt_every must be >= 1");
+    if (scheme == TimeScheme::Implicit && (cg_tol <= 0 || cg_max_iter < 1))
+        throw std::runtime_error("time.cg_tol must be > 0 and time.cg_max_iter >= 1");
+    if (!report.empty() && report != "json")
+        throw std::runtime_error("output.report must be json (or empty for none), got: " + report);
+    if (!report.empty() && report_path.empty())
+        throw std::runtime_error("output.report_path must not be empty");
+    if (tracers.count < 1)
+        throw std::runtime_error("tracers.count must be >= 1");
+    if ((scheme == TimeScheme::Implicit || scheme == TimeScheme::Rkl2) && tracers.count > 1)
+        throw std::runtime_error("time.scheme=" + scheme_to_string(scheme) +
+                                 " advances a single tracer; use tracers.count=1");
+    if (scheme != TimeScheme::Explicit && perf.halo_depth != 1)
+        throw std::runtime_error("time.scheme=" + scheme_to_string(scheme) +
+                                 " requires perf.halo_depth=1");
 }
 
 static void assign_if(const YAML::Node& n, const char* key, int& x) {
@@ -80,6 +187,10 @@ static void assign_if(const YAML::Node& n, const char* key, std::string& x) {
     if (n[key])
         x = n[key].as<std::string>();
 }
+static void assign_if(const YAML::Node& n, const char* key, bool& x) {
+    if (n[key])
+        x = n[key].as<bool>();
+}
 
 SimConfig load_yaml_file(const std::string& path) {
     SimConfig cfg;
@@ -115,6 +226,13 @@ SimConfig load_yaml_file(const std::string& path) {
         assign_if(t, "steps", cfg.steps);
         if (t["out_every"])
             cfg.out_every = t["out_every"].as<int>();
+        if (t["scheme"])
+            cfg.scheme = scheme_from_string(t["scheme"].as<std::string>());
+        assign_if(t, "adaptive", cfg.adaptive_dt);
+        assign_if(t, "cfl", cfg.cfl);
+        assign_if(t, "dt_every", cfg.dt_every);
+        assign_if(t, "cg_tol", cfg.cg_tol);
+        assign_if(t, "cg_max_iter", cfg.cg_max_iter);
     } else {
         assign_if(root, "dt", cfg.dt);
         assign_if(root, "steps", cfg.steps);
@@ -139,9 +257,21 @@ SimConfig load_yaml_file(const std::string& path) {
         }
     }
 
+    if (root["precision"])
+        cfg.precision = precision_from_string(root["precision"].as<std::string>());
+
+    if (root["tracers"]) {
+        auto t = root["tracers"];
+        assign_if(t, "count", cfg.tracers.count);
+        if (t["layout"])
+            cfg.tracers.layout = tracer_layout_from_string(t["layout"].as<std::string>());
+    }
+
     if (root["output"]) {
         auto o = root["output"];
         assign_if(o, "prefix", cfg.output_prefix);
+        assign_if(o, "report", cfg.report);
+        assign_if(o, "report_path", cfg.report_path);
     } else {
         assign_if(root, "output_prefix", cfg.output_prefix);
     }
@@ -166,11 +296,42 @@ SimConfig load_yaml_file(const std::string& path) {
             cfg.ic.var = ic["var"].as<std::string>();
     }
 
+    if (root["perf"]) {
+        auto pf = root["perf"];
+        assign_if(pf, "fused", cfg.perf.fused);
+        assign_if(pf, "simd", cfg.perf.simd);
+        assign_if(pf, "tile_x", cfg.perf.tile_x);
+        assign_if(pf, "tile_y", cfg.perf.tile_y);
+        assign_if(pf, "halo_depth", cfg.perf.halo_depth);
+        assign_if(pf, "overlap", cfg.perf.overlap);
+        assign_if(pf, "threads", cfg.perf.threads);
+        assign_if(pf, "pad_rows", cfg.perf.pad_rows);
+        assign_if(pf, "huge_pages", cfg.perf.huge_pages);
+        assign_if(pf, "halo_backend", cfg.perf.halo_backend);
+        assign_if(pf, "phase_report", cfg.perf.phase_report);
+    }
+
+    if (root["decomp"]) {
+        auto dc = root["decomp"];
+        assign_if(dc, "rebalance_every", cfg.decomp.rebalance_every);
+        assign_if(dc, "rebalance_tol", cfg.decomp.rebalance_tol);
+        assign_if(dc, "node_aware", cfg.decomp.node_aware);
+        assign_if(dc, "ranks_per_node", cfg.decomp.ranks_per_node);
+    }
+
     cfg.validate();
     return cfg;
 }
 
 static bool starts_with(const std::string& s, const std::string& p) { return s.rfind(p, 0) == 0; }
+static bool bool_from_string(const std::string& s) {
+    auto t = lower(s);
+    if (t == "1" || t == "true" || t == "on" || t == "yes")
+        return true;
+    if (t == "0" || t == "false" || t == "off" || t == "no")
+        return false;
+    throw std::runtime_error("Invalid boolean value: " + s);
+}
 static std::optional<std::string> get_value(const std::string& arg, const std::string& key) {
     if (starts_with(arg, "--" + key + "="))
         return arg.substr(key.size() + 3);
@@ -216,6 +377,22 @@ CLIOverrides parse_cli_overrides(const std::vector<std::string>& args) {
             return false;
         };
 
+    auto try_set_bool =
+        [&](const std::string& a, const char* k, std::optional<bool>& dst, size_t i) {
+            if (auto v = get_value(a, k)) {
+                dst = bool_from_string(*v);
+                return true;
+            }
+            if (a == std::string("--") + k) {
+                if (i + 1 < args.size() && !starts_with(args[i + 1], "--"))
+                    dst = bool_from_string(args[i + 1]);
+                else
+                    dst = true;
+                return true;
+            }
+            return false;
+        };
+
     for (size_t i = 0; i < args.size(); ++i) {
         const std::string& a = args[i];
 
@@ -241,6 +418,21 @@ CLIOverrides parse_cli_overrides(const std::vector<std::string>& args) {
             continue;
         if (try_set_int(a, "out_every", o.out_every, i))
             continue;
+        if (try_set_bool(a, "time.adaptive", o.adaptive_dt, i))
+            continue;
+        if (try_set_dbl(a, "time.cfl", o.cfl, i))
+            continue;
+        if (try_set_int(a, "time.dt_every", o.dt_every, i))
+            continue;
+        std::optional<std::string> scheme;
+        if (try_set_str(a, "time.scheme", scheme, i)) {
+            o.scheme = scheme_from_string(*scheme);
+            continue;
+        }
+        if (try_set_dbl(a, "time.cg_tol", o.cg_tol, i))
+            continue;
+        if (try_set_int(a, "time.cg_max_iter", o.cg_max_iter, i))
+            continue;
 
         if (starts_with(a, "--bc.left=") || a == "--bc.left") {
             std::string val;
@@ -283,10 +475,29 @@ CLIOverrides parse_cli_overrides(const std::vector<std::string>& args) {
             continue;
         }
 
+        std::optional<std::string> precision;
+        if (try_set_str(a, "precision", precision, i)) {
+            o.precision = precision_from_string(*precision);
+            continue;
+        }
+
+        if (try_set_int(a, "tracers.count", o.tracer_count, i))
+            continue;
+        std::optional<std::string> tracer_layout;
+        if (try_set_str(a, "tracers.layout", tracer_layout, i)) {
+            o.tracer_layout = tracer_layout_from_string(*tracer_layout);
+            continue;
+        }
+
         if (try_set_str(a, "output.prefix", o.output_prefix, i))
             continue;
         if (try_set_str(a, "output_prefix", o.output_prefix, i))
             continue;
+        if (try_set_str(a, "output.report", o.report, i) || try_set_str(a, "report", o.report, i))
+            continue;
+        if (try_set_str(a, "output.report_path", o.report_path, i) ||
+            try_set_str(a, "report_path", o.report_path, i))
+            continue;
 
         if (try_set_str(a, "ic.mode", o.ic.mode, i))
             continue;
@@ -304,6 +515,38 @@ CLIOverrides parse_cli_overrides(const std::vector<std::string>& args) {
             continue;
         if (try_set_str(a, "ic.var", o.ic.var, i))
             continue;
+
+        if (try_set_bool(a, "perf.fused", o.perf.fused, i))
+            continue;
+        if (try_set_str(a, "perf.simd", o.perf.simd, i))
+            continue;
+        if (try_set_int(a, "perf.tile_x", o.perf.tile_x, i))
+            continue;
+        if (try_set_int(a, "perf.tile_y", o.perf.tile_y, i))
+            continue;
+        if (try_set_int(a, "perf.halo_depth", o.perf.halo_depth, i))
+            continue;
+        if (try_set_bool(a, "perf.overlap", o.perf.overlap, i))
+            continue;
+        if (try_set_int(a, "perf.threads", o.perf.threads, i))
+            continue;
+        if (try_set_bool(a, "perf.pad_rows", o.perf.pad_rows, i))
+            continue;
+        if (try_set_bool(a, "perf.huge_pages", o.perf.huge_pages, i))
+            continue;
+        if (try_set_str(a, "perf.halo_backend", o.perf.halo_backend, i))
+            continue;
+        if (try_set_str(a, "perf.phase_report", o.perf.phase_report, i))
+            continue;
+
+        if (try_set_int(a, "decomp.rebalance_every", o.decomp.rebalance_every, i))
+            continue;
+        if (try_set_dbl(a, "decomp.rebalance_tol", o.decomp.rebalance_tol, i))
+            continue;
+        if (try_set_bool(a, "decomp.node_aware", o.decomp.node_aware, i))
+            continue;
+        if (try_set_int(a, "decomp.ranks_per_node", o.decomp.ranks_per_node, i))
+            continue;
     }
     return o;
 }
@@ -331,6 +574,25 @@ static void apply_overrides(SimConfig& base, const CLIOverrides& o) {
         base.steps = *o.steps;
     if (o.out_every)
         base.out_every = *o.out_every;
+    if (o.adaptive_dt)
+        base.adaptive_dt = *o.adaptive_dt;
+    if (o.cfl)
+        base.cfl = *o.cfl;
+    if (o.dt_every)
+        base.dt_every = *o.dt_every;
+    if (o.scheme)
+        base.scheme = *o.scheme;
+    if (o.cg_tol)
+        base.cg_tol = *o.cg_tol;
+    if (o.cg_max_iter)
+        base.cg_max_iter = *o.cg_max_iter;
+
+    if (o.precision)
+        base.precision = *o.precision;
+    if (o.tracer_count)
+        base.tracers.count = *o.tracer_count;
+    if (o.tracer_layout)
+        base.tracers.layout = *o.tracer_layout;
 
     if (o.bc_left)
         base.bc.left = *o.bc_left;
@@ -343,6 +605,10 @@ static void apply_overrides(SimConfig& base, const CLIOverrides& o) {
 
     if (o.output_prefix)
         base.output_prefix = *o.output_prefix;
+    if (o.report)
+        base.report = *o.report;
+    if (o.report_path)
+        base.report_path = *o.report_path;
 
     if (o.ic.mode)
         base.ic.mode = *o.ic.mode;
@@ -358,6 +624,38 @@ static void apply_overrides(SimConfig& base, const CLIOverrides& o) {
         base.ic.yc_frac = *o.ic.yc_frac;
     if (o.ic.path)
         base.ic.path = *o.ic.path;
+
+    if (o.perf.fused)
+        base.perf.fused = *o.perf.fused;
+    if (o.perf.simd)
+        base.perf.simd = *o.perf.simd;
+    if (o.perf.tile_x)
+        base.perf.tile_x = *o.perf.tile_x;
+    if (o.perf.tile_y)
+        base.perf.tile_y = *o.perf.tile_y;
+    if (o.perf.halo_depth)
+        base.perf.halo_depth = *o.perf.halo_depth;
+    if (o.perf.overlap)
+        base.perf.overlap = *o.perf.overlap;
+    if (o.perf.threads)
+        base.perf.threads = *o.perf.threads;
+    if (o.perf.pad_rows)
+        base.perf.pad_rows = *o.perf.pad_rows;
+    if (o.perf.huge_pages)
+        base.perf.huge_pages = *o.perf.huge_pages;
+    if (o.perf.halo_backend)
+        base.perf.halo_backend = *o.perf.halo_backend;
+    if (o.perf.phase_report)
+        base.perf.phase_report = *o.perf.phase_report;
+
+    if (o.decomp.rebalance_every)
+        base.decomp.rebalance_every = *o.decomp.rebalance_every;
+    if (o.decomp.rebalance_tol)
+        base.decomp.rebalance_tol = *o.decomp.rebalance_tol;
+    if (o.decomp.node_aware)
+        base.decomp.node_aware = *o.decomp.node_aware;
+    if (o.decomp.ranks_per_node)
+        base.decomp.ranks_per_node = *o.decomp.ranks_per_node;
 }
 
 SimConfig merged_config(const std::optional<std::string>& yaml_path,
@@ -390,8 +688,27 @@ int open_netcdf_parallel(const std::string& filename,
     ncmpi_check(ncmpi_def_dim(ncid, "y", dec.ny_global, &dim_y), "def_dim y");
     ncmpi_check(ncmpi_def_dim(ncid, "x", dec.nx_global, &dim_x), "def_dim x");
 
+    int time_varid;
+    ncmpi_check(ncmpi_def_var(ncid, "time", NC_DOUBLE, 1, &dim_time, &time_varid),
+                "def_var time");
+    const std::string time_name = "simulation time";
+    ncmpi_check(ncmpi_put_att_text(ncid, time_varid, "long_name", time_name.size(),
+                                   time_name.c_str()),
+                "put_att time");
+
     int dims[3] = {dim_time, dim_y, dim_x};
-    ncmpi_check(ncmpi_def_var(ncid, "u", NC_DOUBLE, 3, dims, &varid), "def_var u");
+    const nc_type vtype = cfg.precision == Precision::Double ? NC_DOUBLE : NC_FLOAT;
+    // Variable ids follow definition order, so tracer k is `varid + k`.
+    for (int k = 0; k < cfg.tracers.count; ++k) {
+        const std::string name = tracer_var_name(k);
+        int id;
+        ncmpi_check(ncmpi_def_var(ncid, name.c_str(), vtype, 3, dims, &id),
+                    ("def_var " + name).c_str());
+        if (k == 0)
+            varid = id;
+        else if (id != varid + k)
+            throw std::runtime_error("NetCDF variable ids of the tracers are not consecutive");
+    }
 
     write_metadata_netcdf(ncid, cfg);
 
@@ -399,7 +716,41 @@ int open_netcdf_parallel(const std::string& filename,
     return NC_NOERR;
 }
 
-bool write_field_netcdf(int ncid, int varid, const Field& f, const Decomp2D& dec, int step) {
+bool write_time_netcdf(int ncid, int step, double t, const Decomp2D& dec) {
+    int varid;
+    int status = ncmpi_inq_varid(ncid, "time", &varid);
+    if (status == NC_NOERR) {
+        // Collective: every rank takes part, the rank owning the origin writes the value.
+        MPI_Offset start = step;
+        MPI_Offset count = (dec.x_offset == 0 && dec.y_offset == 0) ? 1 : 0;
+        status = ncmpi_put_vara_double_all(ncid, varid, &start, &count, &t);
+    }
+    if (status != NC_NOERR) {
+        std::cerr << "Time write failed: " << ncmpi_strerror(status) << "\n";
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+void pack_interior(const FieldT<T>& f, int k, T* dst) {
+    const int nx = f.nx_local, ny = f.ny_local;
+    const int w = f.cell_width();
+    const int p = f.interleaved() ? 0 : k;
+    const int first = f.interleaved() ? f.halo * w + k : f.halo;
+#pragma omp parallel for schedule(static) if (1L * nx * ny >= kMinParallelCells)
+    for (int j = 0; j < ny; ++j) {
+        const T* src = f.row(j + f.halo, p) + first;
+        T* out = dst + (size_t)j * nx;
+        for (int i = 0; i < nx; ++i) out[i] = src[i * w];
+    }
+}
+
+template void pack_interior(const Field&, int, double*);
+template void pack_interior(const FieldF&, int, float*);
+
+template <typename T>
+bool write_field_netcdf(int ncid, int varid, const FieldT<T>& f, const Decomp2D& dec, int step) {
     MPI_Offset start[3], count[3];
     start[0] = step;
     start[1] = dec.y_offset;
@@ -408,21 +759,26 @@ bool write_field_netcdf(int ncid, int varid, const Field& f, const Decomp2D& dec
     count[1] = dec.ny_local;
     count[2] = dec.nx_local;
 
-    std::vector<double> buf((size_t)dec.nx_local * dec.ny_local);
-    for (int j = 0; j < dec.ny_local; ++j) {
-        for (int i = 0; i < dec.nx_local; ++i) {
-            buf[(size_t)j * dec.nx_local + i] = f.at(i + f.halo, j + f.halo);
-        }
-    }
+    std::vector<T> buf((size_t)dec.nx_local * dec.ny_local);
+    for (int k = 0; k < f.tracers(); ++k) {
+        pack_interior(f, k, buf.data());
 
-    int status = ncmpi_put_vara_double_all(ncid, varid, start, count, buf.data());
-    if (status != NC_NOERR) {
-        std::cerr << "Rank write failed: " << ncmpi_strerror(status) << "\n";
-        return false;
+        int status;
+        if constexpr (std::is_same<T, float>::value)
+            status = ncmpi_put_vara_float_all(ncid, varid + k, start, count, buf.data());
+        else
+            status = ncmpi_put_vara_double_all(ncid, varid + k, start, count, buf.data());
+        if (status != NC_NOERR) {
+            std::cerr << "Rank write failed: " << ncmpi_strerror(status) << "\n";
+            return false;
+        }
     }
     return true;
 }
 
+template bool write_field_netcdf(int, int, const Field&, const Decomp2D&, int);
+template bool write_field_netcdf(int, int, const FieldF&, const Decomp2D&, int);
+
 void close_netcdf_parallel(int ncid) { ncmpi_close(ncid); }
 
 void write_metadata_netcdf(int ncid, const SimConfig& cfg) {
@@ -440,6 +796,11 @@ void write_metadata_netcdf(int ncid, const SimConfig& cfg) {
     put_attr("grid", std::to_string(cfg.nx) + " x " + std::to_string(cfg.ny));
     put_attr("dt", std::to_string(cfg.dt));
     put_attr("steps", std::to_string(cfg.steps));
+    put_attr("precision", precision_to_string(cfg.precision));
+    put_attr("time_scheme", scheme_to_string(cfg.scheme));
+    put_attr("tracers",
+             std::to_string(cfg.tracers.count) + " (" +
+                 tracer_layout_to_string(cfg.tracers.layout) + ")");
     put_attr("D", std::to_string(cfg.D));
     put_attr("velocity", "(" + std::to_string(cfg.vx) + "," + std::to_string(cfg.vy) + ")");
     put_attr("boundary_conditions",
@@ -4,13 +4,17 @@
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <vector>
 namespace fs = std::filesystem;
 
+#include "advect_diffuse.hpp"
 #include "advection.hpp"
+#include "allocator.hpp"
 #include "boundary.hpp"
 #include "decomp.hpp"
 #include "diffusion.hpp"
@@ -18,55 +22,32 @@ namespace fs = std::filesystem;
 #include "halo.hpp"
 #include "init.hpp"
 #include "io.hpp"
+#include "profile.hpp"
+#include "rebalance.hpp"
+#include "report.hpp"
+#include "simd.hpp"
 #include "stability.hpp"
+#include "stepper.hpp"
+#include "sts.hpp"
+#include "subcycle.hpp"
+#include "threads.hpp"
+#include "tiling.hpp"
+#include "timestep.hpp"
 
-int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);
-
-    int world_rank = 0, world_size = 0;
-    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
-
-    std::vector<std::string> args(argv + 1, argv + argc);
-    std::optional<std::string> cfg_path;
-    for (size_t i = 0; i < args.size(); ++i) {
-        const auto& a = args[i];
-        if (a.rfind("--config=", 0) == 0)
-            cfg_path = a.substr(9);
-        else if (a == "--config" && i + 1 < args.size())
-            cfg_path = args[i + 1];
-    }
-
-    SimConfig cfg = merged_config(cfg_path, args);
-
-    double dt_limit = safe_dt(cfg.dx, cfg.dy, cfg.vx, cfg.vy, cfg.D);
-    if (cfg.dt > dt_limit) {
-        if (world_rank == 0) {
-            std::cerr << "[warn] dt=" << cfg.dt << " exceeds stability limit " << dt_limit
-                      << " -> clamping to dt=" << dt_limit << "\n";
-        }
-        cfg.dt = dt_limit;
-    }
-
-    if (world_rank == 0) {
-        std::cout << "climate-sim-mpi-cpp \n"
-                  << "  grid: " << cfg.nx << " x " << cfg.ny << "  dt: " << cfg.dt
-                  << "  steps: " << cfg.steps << "  D: " << cfg.D << "  v=(" << cfg.vx << ","
-                  << cfg.vy << ")\n"
-                  << "  bc: left=" << bc_to_string(cfg.bc.left)
-                  << " right=" << bc_to_string(cfg.bc.right)
-                  << " bottom=" << bc_to_string(cfg.bc.bottom)
-                  << " top=" << bc_to_string(cfg.bc.top) << "\n";
-    }
-
-    Decomp2D dec;
-    dec.init(MPI_COMM_WORLD, cfg.nx, cfg.ny);
-
-    const int halo = 1;
-    Field u(dec.nx_local, dec.ny_local, halo, cfg.dx, cfg.dy);
-    Field tmp(dec.nx_local, dec.ny_local, halo, cfg.dx, cfg.dy);
-    u.fill(0.0);
-    tmp.fill(0.0);
+// Allocates the fields, applies the IC and runs the time loop with storage type `T` and kernel
+// arithmetic `Acc` (see `precision`).
+template <typename T, typename Acc>
+static void run_simulation(const SimConfig& cfg,
+                           Decomp2D& dec,
+                           int world_rank,
+                           double dt_requested) {
+    // Neighbor ranks are cart ranks, which a node-aware grid renumbers.
+    BasicStepper<T, Acc> stepper(cfg, dec, dec.cart_comm);
+    const int halo = stepper.halo();
+    FieldT<T> u(dec.nx_local, dec.ny_local, halo, cfg.dx, cfg.dy, cfg.tracers);
+    FieldT<T> tmp(dec.nx_local, dec.ny_local, halo, cfg.dx, cfg.dy, cfg.tracers);
+    u.fill(T(0));
+    tmp.fill(T(0));
 
     apply_initial_condition(dec, u, cfg);
 
@@ -89,24 +70,45 @@ int main(int argc, char** argv) {
     double t0 = MPI_Wtime();
     double sum_step = 0.0, max_step = 0.0, min_step = 1e300;
 
+    PhaseTimes io_times;  // phases outside the stepper: output and rebalancing
+    TimeController clock(cfg, MPI_COMM_WORLD);
+    LoadBalancer balancer(cfg);
+    std::vector<RebalanceStats> rebalances;
     int time_index = 0;
-    for (int n = 0; n < cfg.steps; ++n) {
+    while (!clock.done()) {
         double ts = MPI_Wtime();
 
-        if (n % cfg.out_every == 0 || n == 0) {
+        if (clock.output_due()) {
+            ScopedPhase p(io_times, Phase::Output);
+            write_time_netcdf(ncid, time_index, clock.time(), dec);
             write_field_netcdf(ncid, varid, u, dec, time_index);
             time_index++;
+            clock.output_written();
         }
 
-        exchange_halos(u, dec, MPI_COMM_WORLD);
-        apply_boundary(u, dec, cfg.bc, 0.0);
-
-        std::copy(u.data.begin(), u.data.end(), tmp.data.begin());
-
-        diffusion_step(u, tmp, cfg.D, cfg.dt);
-        advection_step(u, tmp, cfg.vx, cfg.vy, cfg.dt);
+        const double step_dt = clock.next_dt();
+        if (cfg.adaptive_dt)
+            stepper.set_dt(step_dt);
+        stepper.step(u, tmp);
+        clock.advance(step_dt);
 
-        std::swap(u.data, tmp.data);
+        if (balancer.due(stepper.steps_taken()) && !clock.done()) {
+            ScopedPhase p(io_times, Phase::Rebalance);
+            const RebalanceStats rs = balancer.rebalance(
+                dec, stepper.steps_taken(), busy_seconds(stepper.timings().phases), u, tmp);
+            if (rs.moved)
+                stepper.reset_decomposition();
+            rebalances.push_back(rs);
+            if (world_rank == 0) {
+                std::cout << "rebalance at step " << rs.step << ": imbalance "
+                          << rs.imbalance_before;
+                if (rs.moved)
+                    std::cout << " -> " << rs.imbalance_after << " (predicted), "
+                              << rs.cells_moved << " cells migrated\n";
+                else
+                    std::cout << ", tiles kept\n";
+            }
+        }
 
         double te = MPI_Wtime();
         double dt = te - ts;
@@ -117,21 +119,262 @@ int main(int argc, char** argv) {
             min_step = dt;
     }
 
-    close_netcdf_parallel(ncid);
+    {
+        ScopedPhase p(io_times, Phase::Output);
+        close_netcdf_parallel(ncid);
+    }
 
     double t1 = MPI_Wtime();
     double total = t1 - t0;
 
     double total_max = 0.0, step_worst = 0.0;
-    double avg_step = sum_step / std::max(1, cfg.steps);
+    const long steps = clock.steps_taken();
+    double avg_step = sum_step / std::max(1L, steps);
     MPI_Reduce(&total, &total_max, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
     MPI_Reduce(&avg_step, &step_worst, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
 
+    const StepTimings& st = stepper.timings();
+    PhaseTimes times = st.phases;
+    times += io_times;
+    const double compute = total - io_times[Phase::Output];
+    double compute_max = 0.0;
+    MPI_Reduce(&compute, &compute_max, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    // Halo traffic by where it went: within a node or across the interconnect.
+    const long long on_node = stepper.halo_bytes_on_node();
+    double halo_step[2] = {static_cast<double>(on_node),
+                           static_cast<double>(stepper.halo_bytes() - on_node)};
+    for (double& b : halo_step) b /= std::max(1L, steps);
+    double halo_sum[2] = {0.0, 0.0};
+    MPI_Reduce(halo_step, halo_sum, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    PhaseReport report;
+    report.phases = reduce_phase_times(times, MPI_COMM_WORLD);
+    MPI_Comm_size(MPI_COMM_WORLD, &report.ranks);
+    report.threads = max_threads();
+    report.nx = cfg.nx;
+    report.ny = cfg.ny;
+    report.tracers = cfg.tracers.count;
+    report.steps = steps;
+    report.loop_seconds = total_max;
+    report.compute_seconds = compute_max;
+
+    if (world_rank == 0 && cfg.adaptive_dt) {
+        std::cout << "adaptive dt: " << steps << " steps to t=" << clock.time()
+                  << ", dt min/max=" << clock.min_dt() << " / " << clock.max_dt() << "\n";
+    }
     if (world_rank == 0) {
         std::cout << "timing: total_max=" << total_max << " s, worst_avg_step=" << step_worst
                   << " s\n";
+        std::cout << "throughput: " << report.mlups() << " MLUPS (" << report.compute_mlups()
+                  << " without output)\n";
+        std::cout << "halo bytes/step: " << halo_sum[0] << " intra-node, " << halo_sum[1]
+                  << " inter-node\n";
+        std::ostringstream table;
+        table << std::setprecision(4) << "phases (s over " << report.ranks << " ranks, "
+              << st.exchanges << " exchanges" << (cfg.perf.overlap ? ", overlapped" : "")
+              << "):\n  " << std::left << std::setw(16) << "phase" << std::right
+              << std::setw(12) << "min" << std::setw(12) << "mean" << std::setw(12) << "max"
+              << std::setw(11) << "imbalance" << "\n";
+        for (const PhaseStats& ps : report.phases) {
+            if (ps.calls == 0)
+                continue;
+            table << "  " << std::left << std::setw(16) << phase_to_string(ps.phase) << std::right
+                  << std::setw(12) << ps.min << std::setw(12) << ps.mean << std::setw(12)
+                  << ps.max << std::setw(11) << ps.imbalance << "\n";
+        }
+        std::cout << table.str();
+    }
+    if (world_rank == 0 && cfg.scheme != TimeScheme::Explicit) {
+        const std::string term = cfg.scheme == TimeScheme::Subcycle
+                                     ? stiff_term_to_string(subcycle_split(cfg, cfg.dt).stiff)
+                                     : "diffusion";
+        std::cout << scheme_to_string(cfg.scheme) << " " << term
+                  << ": solve=" << report.phases[static_cast<int>(Phase::KernelSplit)].max
+                  << " s";
+        if (cfg.scheme == TimeScheme::Implicit)
+            std::cout << ", " << st.cg_iterations << " CG iterations ("
+                      << static_cast<double>(st.cg_iterations) / std::max(1L, steps) << "/step)";
+        std::cout << "\n";
+    }
+    if (world_rank == 0 && !cfg.perf.phase_report.empty()) {
+        write_phase_report(cfg.perf.phase_report, report);
+        std::cout << "phase report: " << cfg.perf.phase_report << "\n";
+    }
+
+    if (!cfg.report.empty()) {
+        RankStats local;
+        MPI_Comm_rank(MPI_COMM_WORLD, &local.rank);
+        local.coords[0] = dec.coords[0];
+        local.coords[1] = dec.coords[1];
+        local.nx_local = dec.nx_local;
+        local.ny_local = dec.ny_local;
+        local.x_offset = dec.x_offset;
+        local.y_offset = dec.y_offset;
+        local.step_min = steps > 0 ? min_step : 0.0;
+        local.step_mean = avg_step;
+        local.step_max = max_step;
+        local.halo_bytes_per_step =
+            static_cast<double>(stepper.halo_bytes()) / std::max(1L, steps);
+        local.halo_on_node_bytes_per_step = halo_step[0];
+        local.peak_rss_kb = peak_rss_kb();
+
+        RunReport run;
+        run.ranks = gather_rank_stats(local, MPI_COMM_WORLD);
+        if (world_rank == 0) {
+            run.cfg = cfg;
+            run.dt_requested = dt_requested;
+            run.dims[0] = dec.dims[0];
+            run.dims[1] = dec.dims[1];
+            run.nodes = dec.nodes;
+            run.node_block[0] = dec.node_block[0];
+            run.node_block[1] = dec.node_block[1];
+            run.steps = steps;
+            run.sim_time = clock.time();
+            run.output_records = time_index;
+            // Each record holds every tracer's field plus the time value.
+            const double record_bytes =
+                static_cast<double>(cfg.nx) * cfg.ny * cfg.tracers.count * sizeof(T) +
+                sizeof(double);
+            run.output_bytes = time_index * record_bytes;
+            run.output_seconds = report.phases[static_cast<int>(Phase::Output)].max;
+            run.x_cuts = dec.x_cuts;
+            run.y_cuts = dec.y_cuts;
+            run.rebalances = rebalances;
+            run.phases = report;
+            const fs::path dir = fs::path(cfg.report_path).parent_path();
+            if (!dir.empty())
+                fs::create_directories(dir);
+            write_run_report(cfg.report_path, run);
+            std::cout << "run report: " << cfg.report_path << "\n";
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    // Only the main thread calls MPI; OpenMP teams run between MPI calls.
+    int thread_level = MPI_THREAD_SINGLE;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_level);
+
+    int world_rank = 0, world_size = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::optional<std::string> cfg_path;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const auto& a = args[i];
+        if (a.rfind("--config=", 0) == 0)
+            cfg_path = a.substr(9);
+        else if (a == "--config" && i + 1 < args.size())
+            cfg_path = args[i + 1];
+    }
+
+    SimConfig cfg = merged_config(cfg_path, args);
+
+    // Backward Euler is unconditionally stable and RKL2 picks its stage count from dt: only
+    // advection limits their dt. Subcycling is limited by the non-stiff term only. Adaptive mode
+    // picks stable steps itself and keeps `dt` as the output interval.
+    const double dt_requested = cfg.dt;
+    double dt_limit = local_dt_limit(cfg);
+    if (!cfg.adaptive_dt && cfg.dt > dt_limit) {
+        if (world_rank == 0) {
+            std::cerr << "[warn] dt=" << cfg.dt << " exceeds stability limit " << dt_limit
+                      << " -> clamping to dt=" << dt_limit << "\n";
+        }
+        cfg.dt = dt_limit;
+    }
+
+    set_simd_level(resolve_simd_level(cfg.perf.simd));
+    set_threads(cfg.perf.threads);
+    if (max_threads() > 1 && thread_level < MPI_THREAD_FUNNELED && world_rank == 0)
+        std::cerr << "[warn] MPI library does not provide MPI_THREAD_FUNNELED\n";
+
+    if (world_rank == 0) {
+        std::cout << "climate-sim-mpi-cpp \n"
+                  << "  grid: " << cfg.nx << " x " << cfg.ny << "  dt: " << cfg.dt;
+        if (cfg.adaptive_dt)
+            std::cout << " (adaptive, cfl " << cfg.cfl << ")";
+        std::cout << "  steps: " << cfg.steps << "  scheme: " << scheme_to_string(cfg.scheme)
+                  << "  D: " << cfg.D << "  v=(" << cfg.vx << "," << cfg.vy << ")\n"
+                  << "  bc: left=" << bc_to_string(cfg.bc.left)
+                  << " right=" << bc_to_string(cfg.bc.right)
+                  << " bottom=" << bc_to_string(cfg.bc.bottom)
+                  << " top=" << bc_to_string(cfg.bc.top) << "\n"
+                  << "  kernel: " << (cfg.perf.fused ? "fused" : "reference")
+                  << "  simd: " << simd_to_string(active_simd_level()) << " (requested "
+                  << cfg.perf.simd << ")  precision: " << precision_to_string(cfg.precision)
+                  << "\n"
+                  << "  ranks: " << world_size << "  threads/rank: " << max_threads();
+        if (cfg.tracers.count > 1)
+            std::cout << "  tracers: " << cfg.tracers.count << " ("
+                      << tracer_layout_to_string(cfg.tracers.layout) << ")";
+        std::cout << "\n";
+        if (cfg.scheme == TimeScheme::Rkl2 && cfg.D > 0.0 && !cfg.adaptive_dt) {
+            const double dt_diff = safe_dt(cfg.dx, cfg.dy, 0.0, 0.0, cfg.D);
+            std::cout << "  rkl2: " << rkl2_stages(cfg.dt, dt_diff) << " stages, dt = "
+                      << cfg.dt / dt_diff << " x diffusion limit\n";
+        }
+        if (cfg.scheme == TimeScheme::Subcycle) {
+            const SubcycleSplit split = subcycle_split(cfg, cfg.dt);
+            std::cout << "  subcycle: " << stiff_term_to_string(split.stiff) << " in "
+                      << split.substeps << " substeps per step"
+                      << (cfg.adaptive_dt ? " (at the nominal dt)" : "")
+                      << ", limits adv=" << split.dt_adv << " diff=" << split.dt_diff << "\n";
+        }
+    }
+
+    Decomp2D dec;
+    if (cfg.decomp.node_aware)
+        dec.init_node_aware(MPI_COMM_WORLD, cfg.nx, cfg.ny, cfg.decomp.ranks_per_node);
+    else
+        dec.init(MPI_COMM_WORLD, cfg.nx, cfg.ny);
+    if (world_rank == 0) {
+        std::cout << "  process grid: " << dec.dims[0] << " x " << dec.dims[1] << " on "
+                  << dec.nodes << (dec.nodes == 1 ? " node" : " nodes");
+        if (dec.node_block[0] > 0)
+            std::cout << " (node blocks of " << dec.node_block[0] << " x " << dec.node_block[1]
+                      << ")";
+        else if (cfg.decomp.node_aware)
+            std::cout << " (uneven nodes, flat placement)";
+        std::cout << "\n";
+    }
+
+    const TileShape tiles = resolve_tile_shape(cfg.perf.tile_x,
+                                               cfg.perf.tile_y,
+                                               dec.nx_local,
+                                               dec.ny_local,
+                                               precision_storage_bytes(cfg.precision));
+    set_tile_shape(tiles);
+    if (world_rank == 0) {
+        std::cout << "  tiles: " << tiles.tx << " x " << tiles.ty
+                  << " (L2 " << (l2_cache_bytes() >> 10) << " KiB)"
+                  << "  halo_depth: " << cfg.perf.halo_depth
+                  << "  halo_backend: " << cfg.perf.halo_backend << "\n";
+    }
+
+    const HaloBackend backend = halo_backend_from_string(cfg.perf.halo_backend);
+    set_halo_backend(backend);
+    if (backend == HaloBackend::Shm)
+        enable_shared_fields(MPI_COMM_WORLD);
+    set_field_layout(
+        FieldLayout{cfg.perf.pad_rows, cfg.perf.huge_pages, backend == HaloBackend::Shm});
+    // Before the first parallel region, so every OpenMP thread inherits the mode.
+    set_flush_denormals(cfg.precision != Precision::Double);
+    switch (cfg.precision) {
+        case Precision::Double:
+            run_simulation<double, double>(cfg, dec, world_rank, dt_requested);
+            break;
+        case Precision::Float:
+            run_simulation<float, float>(cfg, dec, world_rank, dt_requested);
+            break;
+        case Precision::Mixed:
+            run_simulation<float, double>(cfg, dec, world_rank, dt_requested);
+            break;
     }
 
+    // Every shared field is gone with run_simulation's locals.
+    disable_shared_fields();
     dec.finalize();
     MPI_Finalize();
     return 0;
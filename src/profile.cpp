@@ -0,0 +1,135 @@
+#include "profile.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+std::string phase_to_string(Phase p) {
+    switch (p) {
+        case Phase::HaloPost:
+            return "halo_post";
+        case Phase::HaloWait:
+            return "halo_wait";
+        case Phase::Boundary:
+            return "boundary";
+        case Phase::KernelInterior:
+            return "kernel_interior";
+        case Phase::KernelEdges:
+            return "kernel_edges";
+        case Phase::KernelSplit:
+            return "kernel_split";
+        case Phase::Swap:
+            return "swap";
+        case Phase::Output:
+            return "output";
+        case Phase::Rebalance:
+            return "rebalance";
+    }
+    return "unknown";
+}
+
+PhaseTimes& PhaseTimes::operator+=(const PhaseTimes& o) {
+    for (int p = 0; p < kPhaseCount; ++p) {
+        seconds[p] += o.seconds[p];
+        calls[p] += o.calls[p];
+    }
+    return *this;
+}
+
+std::vector<PhaseStats> reduce_phase_times(const PhaseTimes& times, MPI_Comm comm) {
+    int size = 1;
+    MPI_Comm_size(comm, &size);
+
+    double mn[kPhaseCount], mx[kPhaseCount], sum[kPhaseCount];
+    long calls[kPhaseCount];
+    MPI_Allreduce(times.seconds, mn, kPhaseCount, MPI_DOUBLE, MPI_MIN, comm);
+    MPI_Allreduce(times.seconds, mx, kPhaseCount, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Allreduce(times.seconds, sum, kPhaseCount, MPI_DOUBLE, MPI_SUM, comm);
+    MPI_Allreduce(times.calls, calls, kPhaseCount, MPI_LONG, MPI_MAX, comm);
+
+    std::vector<PhaseStats> stats(kPhaseCount);
+    for (int p = 0; p < kPhaseCount; ++p) {
+        PhaseStats& s = stats[p];
+        s.phase = static_cast<Phase>(p);
+        s.min = mn[p];
+        s.max = mx[p];
+        s.mean = sum[p] / size;
+        s.imbalance = s.mean > 0.0 ? s.max / s.mean - 1.0 : 0.0;
+        s.calls = calls[p];
+    }
+    return stats;
+}
+
+double mlups(double cell_updates, double seconds) {
+    return seconds > 0.0 ? cell_updates / seconds * 1e-6 : 0.0;
+}
+
+double PhaseReport::mlups() const {
+    return ::mlups(static_cast<double>(nx) * ny * tracers * steps, loop_seconds);
+}
+
+double PhaseReport::compute_mlups() const {
+    return ::mlups(static_cast<double>(nx) * ny * tracers * steps, compute_seconds);
+}
+
+namespace {
+
+bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void write_csv(std::ostream& os, const PhaseReport& r) {
+    os << "# ranks=" << r.ranks << " threads=" << r.threads << " grid=" << r.nx << "x" << r.ny
+       << " tracers=" << r.tracers << " steps=" << r.steps << " loop_s=" << r.loop_seconds
+       << " compute_s=" << r.compute_seconds << " mlups=" << r.mlups()
+       << " compute_mlups=" << r.compute_mlups() << "\n";
+    os << "phase,calls,min_s,mean_s,max_s,imbalance\n";
+    for (const PhaseStats& s : r.phases)
+        os << phase_to_string(s.phase) << "," << s.calls << "," << s.min << "," << s.mean << ","
+           << s.max << "," << s.imbalance << "\n";
+}
+
+void write_json(std::ostream& os, const PhaseReport& r) {
+    os << "{\n"
+       << "  \"ranks\": " << r.ranks << ",\n"
+       << "  \"threads\": " << r.threads << ",\n"
+       << "  \"nx\": " << r.nx << ",\n"
+       << "  \"ny\": " << r.ny << ",\n"
+       << "  \"tracers\": " << r.tracers << ",\n"
+       << "  \"steps\": " << r.steps << ",\n"
+       << "  \"loop_s\": " << r.loop_seconds << ",\n"
+       << "  \"compute_s\": " << r.compute_seconds << ",\n"
+       << "  \"mlups\": " << r.mlups() << ",\n"
+       << "  \"compute_mlups\": " << r.compute_mlups() << ",\n"
+       << "  \"phases\": ";
+    write_phases_json(os, r.phases, "  ");
+    os << "\n}\n";
+}
+
+}  // namespace
+
+void write_phases_json(std::ostream& os, const std::vector<PhaseStats>& phases,
+                       const std::string& indent) {
+    os << "[";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const PhaseStats& s = phases[i];
+        os << (i ? ",\n" : "\n") << indent << "  {\"phase\": \"" << phase_to_string(s.phase)
+           << "\", \"calls\": " << s.calls << ", \"min_s\": " << s.min
+           << ", \"mean_s\": " << s.mean << ", \"max_s\": " << s.max
+           << ", \"imbalance\": " << s.imbalance << "}";
+    }
+    os << "\n" << indent << "]";
+}
+
+void write_phase_report(const std::string& path, const PhaseReport& r) {
+    std::ofstream os(path);
+    if (!os)
+        throw std::runtime_error("cannot open phase report: " + path);
+    os.precision(9);
+    if (ends_with(path, ".csv"))
+        write_csv(os, r);
+    else
+        write_json(os, r);
+    if (!os)
+        throw std::runtime_error("failed writing phase report: " + path);
+}
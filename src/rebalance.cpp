@@ -0,0 +1,267 @@
+#include "rebalance.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+double load_imbalance(const std::vector<double>& costs) {
+    if (costs.empty())
+        return 0.0;
+    double sum = 0.0, mx = 0.0;
+    for (double c : costs) {
+        sum += c;
+        mx = std::max(mx, c);
+    }
+    const double mean = sum / costs.size();
+    return mean > 0.0 ? mx / mean - 1.0 : 0.0;
+}
+
+std::vector<int> balance_cuts(const std::vector<int>& cuts,
+                              const std::vector<double>& slab_cost,
+                              int min_width) {
+    const int n = static_cast<int>(slab_cost.size());
+    if (static_cast<int>(cuts.size()) != n + 1)
+        throw std::runtime_error("balance_cuts: need one cost per slab");
+    std::vector<double> cum(n + 1, 0.0);
+    for (int i = 0; i < n; ++i) cum[i + 1] = cum[i] + std::max(0.0, slab_cost[i]);
+    for (int i = 0; i < n; ++i)
+        if (cuts[i + 1] - cuts[i] < min_width)
+            return cuts;
+    const double total = cum[n];
+    if (total <= 0.0)
+        return cuts;
+
+    const int width = cuts[n];
+    std::vector<int> out = cuts;
+    int s = 0;  // slab holding the current target
+    for (int k = 1; k < n; ++k) {
+        const double target = total * k / n;
+        while (s < n - 1 && cum[s + 1] < target) ++s;
+        const double cost = cum[s + 1] - cum[s];
+        const double frac = cost > 0.0 ? (target - cum[s]) / cost : 0.0;
+        const double pos = cuts[s] + frac * (cuts[s + 1] - cuts[s]);
+        // Stay between the neighboring old cuts and leave room for the slabs on either side.
+        const int lo = std::max(cuts[k - 1], out[k - 1] + min_width);
+        const int hi = std::min(cuts[k + 1], width - (n - k) * min_width);
+        out[k] = std::clamp(static_cast<int>(std::lround(pos)), lo, hi);
+    }
+    return out;
+}
+
+namespace {
+
+// Fraction of old slab i that lies in new slab a, for the nonzero pairs: w[a] = {(i, fraction)}.
+std::vector<std::vector<std::pair<int, double>>> overlap_weights(const std::vector<int>& old_cuts,
+                                                                 const std::vector<int>& new_cuts) {
+    const int n = static_cast<int>(old_cuts.size()) - 1;
+    std::vector<std::vector<std::pair<int, double>>> w(n);
+    for (int a = 0; a < n; ++a) {
+        for (int i = 0; i < n; ++i) {
+            const int lo = std::max(new_cuts[a], old_cuts[i]);
+            const int hi = std::min(new_cuts[a + 1], old_cuts[i + 1]);
+            if (hi > lo) {
+                const double width = old_cuts[i + 1] - old_cuts[i];
+                w[a].emplace_back(i, (hi - lo) / width);
+            }
+        }
+    }
+    return w;
+}
+
+// Global cell range [x0, x1) x [y0, y1).
+struct Box {
+    int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+
+    bool empty() const { return x0 >= x1 || y0 >= y1; }
+    long long cells() const { return empty() ? 0 : 1LL * (x1 - x0) * (y1 - y0); }
+};
+
+Box tile(const std::vector<int>& xc, const std::vector<int>& yc, int i, int j) {
+    return {xc[i], xc[i + 1], yc[j], yc[j + 1]};
+}
+
+Box meet(const Box& a, const Box& b) {
+    return {std::max(a.x0, b.x0), std::min(a.x1, b.x1), std::max(a.y0, b.y0),
+            std::min(a.y1, b.y1)};
+}
+
+// Calls fn(row pointer, values) for every row of `b` in every plane of `f`, whose interior is the
+// global range `own`. Packing and unpacking walk the rows in the same order.
+template <typename FieldType, typename Fn>
+void for_each_row(FieldType& f, const Box& own, const Box& b, Fn fn) {
+    const int w = f.cell_width();
+    const size_t len = static_cast<size_t>(b.x1 - b.x0) * w;
+    const size_t first = static_cast<size_t>(b.x0 - own.x0 + f.halo) * w;
+    for (int p = 0; p < f.planes(); ++p)
+        for (int y = b.y0; y < b.y1; ++y) fn(f.row(y - own.y0 + f.halo, p) + first, len);
+}
+
+template <typename T>
+std::vector<T> pack(const FieldT<T>& f, const Box& own, const Box& b) {
+    std::vector<T> buf;
+    buf.reserve(b.cells() * f.tracers());
+    for_each_row(f, own, b,
+                 [&](const T* row, size_t len) { buf.insert(buf.end(), row, row + len); });
+    return buf;
+}
+
+template <typename T>
+void unpack(FieldT<T>& f, const Box& own, const Box& b, const std::vector<T>& buf) {
+    const T* in = buf.data();
+    for_each_row(f, own, b, [&](T* row, size_t len) {
+        std::copy(in, in + len, row);
+        in += len;
+    });
+}
+
+}  // namespace
+
+std::vector<double> predicted_costs(const std::vector<double>& cost,
+                                    const std::vector<int>& old_x,
+                                    const std::vector<int>& old_y,
+                                    const std::vector<int>& new_x,
+                                    const std::vector<int>& new_y) {
+    const int px = static_cast<int>(old_x.size()) - 1;
+    const int py = static_cast<int>(old_y.size()) - 1;
+    const auto wx = overlap_weights(old_x, new_x);
+    const auto wy = overlap_weights(old_y, new_y);
+    std::vector<double> out(cost.size(), 0.0);
+    for (int b = 0; b < py; ++b)
+        for (int a = 0; a < px; ++a)
+            for (const auto& [j, fy] : wy[b])
+                for (const auto& [i, fx] : wx[a]) out[a + px * b] += fx * fy * cost[i + px * j];
+    return out;
+}
+
+template <typename T>
+long long migrate_field(const FieldT<T>& src,
+                        FieldT<T>& dst,
+                        const Decomp2D& dec,
+                        const std::vector<int>& old_x,
+                        const std::vector<int>& old_y) {
+    const int px = dec.dims[0], py = dec.dims[1];
+    const int cx = dec.coords[0], cy = dec.coords[1];
+    const Box old_own = tile(old_x, old_y, cx, cy);
+    const Box new_own = tile(dec.x_cuts, dec.y_cuts, cx, cy);
+    if (new_own.x0 < old_x[std::max(cx - 1, 0)] || new_own.x1 > old_x[std::min(cx + 2, px)] ||
+        new_own.y0 < old_y[std::max(cy - 1, 0)] || new_own.y1 > old_y[std::min(cy + 2, py)])
+        throw std::runtime_error("migrate_field: a cut moved past a neighboring tile");
+
+    const MPI_Datatype type = std::is_same<T, float>::value ? MPI_FLOAT : MPI_DOUBLE;
+    constexpr int kTag = 41;
+    std::vector<std::vector<T>> sends, recvs;
+    std::vector<Box> recv_boxes;
+    std::vector<MPI_Request> reqs;
+    sends.reserve(8);
+    recvs.reserve(8);
+    long long received = 0;
+    for (int dj = -1; dj <= 1; ++dj) {
+        for (int di = -1; di <= 1; ++di) {
+            int c[2] = {cx + di, cy + dj};
+            if (c[0] < 0 || c[0] >= px || c[1] < 0 || c[1] >= py)
+                continue;
+            if (di == 0 && dj == 0) {
+                const Box keep = meet(old_own, new_own);
+                if (!keep.empty())
+                    unpack(dst, new_own, keep, pack(src, old_own, keep));
+                continue;
+            }
+            int nbr = MPI_PROC_NULL;
+            MPI_Cart_rank(dec.cart_comm, c, &nbr);
+            const Box in = meet(tile(old_x, old_y, c[0], c[1]), new_own);
+            if (!in.empty()) {
+                recvs.emplace_back(in.cells() * src.tracers());
+                recv_boxes.push_back(in);
+                reqs.emplace_back();
+                MPI_Irecv(recvs.back().data(), static_cast<int>(recvs.back().size()), type, nbr,
+                          kTag, dec.cart_comm, &reqs.back());
+                received += in.cells();
+            }
+            const Box out = meet(old_own, tile(dec.x_cuts, dec.y_cuts, c[0], c[1]));
+            if (!out.empty()) {
+                sends.push_back(pack(src, old_own, out));
+                reqs.emplace_back();
+                MPI_Isend(sends.back().data(), static_cast<int>(sends.back().size()), type, nbr,
+                          kTag, dec.cart_comm, &reqs.back());
+            }
+        }
+    }
+    MPI_Waitall(static_cast<int>(reqs.size()), reqs.data(), MPI_STATUSES_IGNORE);
+    for (size_t r = 0; r < recvs.size(); ++r) unpack(dst, new_own, recv_boxes[r], recvs[r]);
+    return received;
+}
+
+template long long migrate_field(const Field&, Field&, const Decomp2D&, const std::vector<int>&,
+                                 const std::vector<int>&);
+template long long migrate_field(const FieldF&, FieldF&, const Decomp2D&,
+                                 const std::vector<int>&, const std::vector<int>&);
+
+double busy_seconds(const PhaseTimes& t) {
+    return t[Phase::Boundary] + t[Phase::KernelInterior] + t[Phase::KernelEdges] +
+           t[Phase::KernelSplit] + t[Phase::Swap];
+}
+
+LoadBalancer::LoadBalancer(const SimConfig& cfg)
+    : every_(cfg.decomp.rebalance_every),
+      min_width_(cfg.perf.halo_depth),
+      tol_(cfg.decomp.rebalance_tol) {}
+
+template <typename T>
+RebalanceStats LoadBalancer::rebalance(Decomp2D& dec,
+                                       long step,
+                                       double busy,
+                                       FieldT<T>& u,
+                                       FieldT<T>& tmp) {
+    RebalanceStats st;
+    st.step = step;
+    const double cost = busy - last_busy_;
+    last_busy_ = busy;
+
+    int size = 1;
+    MPI_Comm_size(dec.cart_comm, &size);
+    std::vector<double> by_rank(size);
+    MPI_Allgather(&cost, 1, MPI_DOUBLE, by_rank.data(), 1, MPI_DOUBLE, dec.cart_comm);
+
+    const int px = dec.dims[0], py = dec.dims[1];
+    std::vector<double> grid(by_rank.size()), cols(px, 0.0), rows(py, 0.0);
+    for (int r = 0; r < size; ++r) {
+        int c[2];
+        MPI_Cart_coords(dec.cart_comm, r, 2, c);
+        grid[c[0] + px * c[1]] = by_rank[r];
+        cols[c[0]] += by_rank[r];
+        rows[c[1]] += by_rank[r];
+    }
+    st.imbalance_before = st.imbalance_after = load_imbalance(grid);
+    if (st.imbalance_before <= tol_)
+        return st;
+
+    // Every rank holds the same costs, so every rank computes the same cuts.
+    const std::vector<int> new_x = balance_cuts(dec.x_cuts, cols, min_width_);
+    const std::vector<int> new_y = balance_cuts(dec.y_cuts, rows, min_width_);
+    if (new_x == dec.x_cuts && new_y == dec.y_cuts)
+        return st;
+    const double predicted =
+        load_imbalance(predicted_costs(grid, dec.x_cuts, dec.y_cuts, new_x, new_y));
+    if (predicted >= st.imbalance_before)
+        return st;
+
+    const std::vector<int> old_x = dec.x_cuts, old_y = dec.y_cuts;
+    dec.set_cuts(new_x, new_y);
+    FieldT<T> fresh(dec.nx_local, dec.ny_local, u.halo, u.dx, u.dy, u.tracer);
+    fresh.fill(T(0));
+    long long moved = migrate_field(u, fresh, dec, old_x, old_y);
+    u = std::move(fresh);
+    tmp = FieldT<T>(dec.nx_local, dec.ny_local, u.halo, u.dx, u.dy, u.tracer);
+    tmp.fill(T(0));
+
+    MPI_Allreduce(MPI_IN_PLACE, &moved, 1, MPI_LONG_LONG, MPI_SUM, dec.cart_comm);
+    st.moved = true;
+    st.imbalance_after = predicted;
+    st.cells_moved = moved;
+    return st;
+}
+
+template RebalanceStats LoadBalancer::rebalance(Decomp2D&, long, double, Field&, Field&);
+template RebalanceStats LoadBalancer::rebalance(Decomp2D&, long, double, FieldF&, FieldF&);
@@ -0,0 +1,170 @@
+#include "report.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+long peak_rss_kb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            std::istringstream is(line.substr(6));
+            long kb = -1;
+            is >> kb;
+            return kb;
+        }
+    }
+    return -1;
+}
+
+std::vector<RankStats> gather_rank_stats(const RankStats& local, MPI_Comm comm) {
+    int rank = 0, size = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    // Plain data on a homogeneous machine: ship the bytes.
+    std::vector<RankStats> all(rank == 0 ? size : 0);
+    MPI_Gather(&local, sizeof(RankStats), MPI_BYTE, all.data(), sizeof(RankStats), MPI_BYTE, 0,
+               comm);
+    return all;
+}
+
+namespace {
+
+std::string quoted(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+const char* boolean(bool b) { return b ? "true" : "false"; }
+
+std::string int_list(const std::vector<int>& v) {
+    std::ostringstream os;
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) os << (i ? ", " : "") << v[i];
+    os << "]";
+    return os.str();
+}
+
+void write_config(std::ostream& os, const RunReport& r) {
+    const SimConfig& c = r.cfg;
+    os << "  \"config\": {\n"
+       << "    \"grid\": {\"nx\": " << c.nx << ", \"ny\": " << c.ny << ", \"dx\": " << c.dx
+       << ", \"dy\": " << c.dy << "},\n"
+       << "    \"physics\": {\"D\": " << c.D << ", \"vx\": " << c.vx << ", \"vy\": " << c.vy
+       << "},\n"
+       << "    \"time\": {\"dt\": " << c.dt << ", \"dt_requested\": " << r.dt_requested
+       << ", \"dt_clamped\": " << boolean(c.dt != r.dt_requested) << ", \"steps\": " << c.steps
+       << ", \"out_every\": " << c.out_every << ", \"scheme\": "
+       << quoted(scheme_to_string(c.scheme)) << ", \"adaptive\": " << boolean(c.adaptive_dt)
+       << ", \"cfl\": " << c.cfl << ", \"dt_every\": " << c.dt_every
+       << ", \"cg_tol\": " << c.cg_tol << ", \"cg_max_iter\": " << c.cg_max_iter << "},\n"
+       << "    \"bc\": {\"left\": " << quoted(bc_to_string(c.bc.left))
+       << ", \"right\": " << quoted(bc_to_string(c.bc.right))
+       << ", \"bottom\": " << quoted(bc_to_string(c.bc.bottom))
+       << ", \"top\": " << quoted(bc_to_string(c.bc.top)) << "},\n"
+       << "    \"precision\": " << quoted(precision_to_string(c.precision)) << ",\n"
+       << "    \"tracers\": {\"count\": " << c.tracers.count
+       << ", \"layout\": " << quoted(tracer_layout_to_string(c.tracers.layout)) << "},\n"
+       << "    \"ic\": {\"mode\": " << quoted(c.ic.mode) << ", \"preset\": " << quoted(c.ic.preset)
+       << ", \"A\": " << c.ic.A << ", \"sigma_frac\": " << c.ic.sigma_frac
+       << ", \"xc_frac\": " << c.ic.xc_frac << ", \"yc_frac\": " << c.ic.yc_frac
+       << ", \"path\": " << quoted(c.ic.path) << ", \"var\": " << quoted(c.ic.var) << "},\n"
+       << "    \"perf\": {\"fused\": " << boolean(c.perf.fused)
+       << ", \"simd\": " << quoted(c.perf.simd) << ", \"tile_x\": " << c.perf.tile_x
+       << ", \"tile_y\": " << c.perf.tile_y << ", \"halo_depth\": " << c.perf.halo_depth
+       << ", \"overlap\": " << boolean(c.perf.overlap) << ", \"threads\": " << c.perf.threads
+       << ", \"pad_rows\": " << boolean(c.perf.pad_rows)
+       << ", \"huge_pages\": " << boolean(c.perf.huge_pages)
+       << ", \"halo_backend\": " << quoted(c.perf.halo_backend)
+       << ", \"phase_report\": " << quoted(c.perf.phase_report) << "},\n"
+       << "    \"decomp\": {\"rebalance_every\": " << c.decomp.rebalance_every
+       << ", \"rebalance_tol\": " << c.decomp.rebalance_tol
+       << ", \"node_aware\": " << boolean(c.decomp.node_aware)
+       << ", \"ranks_per_node\": " << c.decomp.ranks_per_node << "},\n"
+       << "    \"output\": {\"prefix\": " << quoted(c.output_prefix)
+       << ", \"report\": " << quoted(c.report) << ", \"report_path\": " << quoted(c.report_path)
+       << "}\n"
+       << "  },\n";
+}
+
+}  // namespace
+
+void write_run_report(const std::string& path, const RunReport& r) {
+    std::ofstream os(path);
+    if (!os)
+        throw std::runtime_error("cannot open run report: " + path);
+    os.precision(9);
+
+    double step_min = 1e300, step_max = 0.0, step_mean = 0.0;
+    double halo_total = 0.0, halo_max = 0.0, halo_on_node = 0.0;
+    long rss_max = -1, rss_total = 0;
+    for (const RankStats& s : r.ranks) {
+        step_min = std::min(step_min, s.step_min);
+        step_max = std::max(step_max, s.step_max);
+        step_mean += s.step_mean / r.ranks.size();
+        halo_total += s.halo_bytes_per_step;
+        halo_max = std::max(halo_max, s.halo_bytes_per_step);
+        halo_on_node += s.halo_on_node_bytes_per_step;
+        rss_max = std::max(rss_max, s.peak_rss_kb);
+        rss_total += std::max(0L, s.peak_rss_kb);
+    }
+    if (r.ranks.empty())
+        step_min = 0.0;
+
+    os << "{\n";
+    write_config(os, r);
+    os << "  \"decomposition\": {\"ranks\": " << r.ranks.size() << ", \"dims\": [" << r.dims[0]
+       << ", " << r.dims[1] << "], \"nodes\": " << r.nodes << ", \"node_block\": ["
+       << r.node_block[0] << ", " << r.node_block[1] << "], \"x_cuts\": " << int_list(r.x_cuts)
+       << ", \"y_cuts\": " << int_list(r.y_cuts) << "},\n"
+       << "  \"rebalances\": [";
+    for (size_t i = 0; i < r.rebalances.size(); ++i) {
+        const RebalanceStats& b = r.rebalances[i];
+        os << (i ? ",\n" : "\n") << "    {\"step\": " << b.step
+           << ", \"moved\": " << boolean(b.moved)
+           << ", \"imbalance_before\": " << b.imbalance_before
+           << ", \"imbalance_after\": " << b.imbalance_after
+           << ", \"cells_moved\": " << b.cells_moved << "}";
+    }
+    os << (r.rebalances.empty() ? "],\n" : "\n  ],\n")
+       << "  \"steps\": " << r.steps << ",\n"
+       << "  \"sim_time\": " << r.sim_time << ",\n"
+       << "  \"step_time\": {\"min_s\": " << step_min << ", \"mean_s\": " << step_mean
+       << ", \"max_s\": " << step_max << "},\n"
+       << "  \"throughput\": {\"loop_s\": " << r.phases.loop_seconds
+       << ", \"mlups\": " << r.phases.mlups()
+       << ", \"compute_mlups\": " << r.phases.compute_mlups() << "},\n"
+       << "  \"output\": {\"records\": " << r.output_records << ", \"bytes\": " << r.output_bytes
+       << ", \"seconds\": " << r.output_seconds << ", \"bandwidth_mbs\": "
+       << (r.output_seconds > 0.0 ? r.output_bytes / r.output_seconds * 1e-6 : 0.0) << "},\n"
+       << "  \"halo\": {\"bytes_per_step\": " << halo_total
+       << ", \"max_rank_bytes_per_step\": " << halo_max
+       << ", \"intra_node_bytes_per_step\": " << halo_on_node
+       << ", \"inter_node_bytes_per_step\": " << halo_total - halo_on_node << "},\n"
+       << "  \"memory\": {\"peak_rss_kb_max\": " << rss_max
+       << ", \"peak_rss_kb_total\": " << rss_total << "},\n"
+       << "  \"ranks\": [";
+    for (size_t i = 0; i < r.ranks.size(); ++i) {
+        const RankStats& s = r.ranks[i];
+        os << (i ? ",\n" : "\n") << "    {\"rank\": " << s.rank << ", \"coords\": ["
+           << s.coords[0] << ", " << s.coords[1] << "], \"nx_local\": " << s.nx_local
+           << ", \"ny_local\": " << s.ny_local << ", \"x_offset\": " << s.x_offset
+           << ", \"y_offset\": " << s.y_offset << ", \"step_min_s\": " << s.step_min
+           << ", \"step_mean_s\": " << s.step_mean << ", \"step_max_s\": " << s.step_max
+           << ", \"halo_bytes_per_step\": " << s.halo_bytes_per_step
+           << ", \"halo_on_node_bytes_per_step\": " << s.halo_on_node_bytes_per_step
+           << ", \"peak_rss_kb\": " << s.peak_rss_kb << "}";
+    }
+    os << "\n  ],\n  \"phases\": ";
+    write_phases_json(os, r.phases.phases, "  ");
+    os << "\n}\n";
+    if (!os)
+        throw std::runtime_error("failed writing run report: " + path);
+}
@@ -0,0 +1,214 @@
+#include "shm.hpp"
+
+#include <algorithm>
+#include <list>
+#include <new>
+#include <stdexcept>
+
+#include "allocator.hpp"
+
+static_assert(std::atomic<long>::is_always_lock_free,
+              "shared-memory flags need address-free (lock-free) atomics");
+
+namespace {
+
+MPI_Comm& field_node() {
+    static MPI_Comm comm = MPI_COMM_NULL;
+    return comm;
+}
+
+// A list, so the entries HaloPlans point to stay put while other buffers come and go.
+std::list<SharedBuffer>& shared_buffers() {
+    static std::list<SharedBuffer> buffers;
+    return buffers;
+}
+
+long next_buffer_id = 0;
+
+// Rank of `r` (a rank of `from`, or MPI_PROC_NULL) in `to`, or -1 when it is not a member.
+int translate(MPI_Comm from, int r, MPI_Comm to) {
+    if (r == MPI_PROC_NULL || to == MPI_COMM_NULL)
+        return -1;
+    MPI_Group gf, gt;
+    MPI_Comm_group(from, &gf);
+    MPI_Comm_group(to, &gt);
+    int out = MPI_UNDEFINED;
+    MPI_Group_translate_ranks(gf, 1, &r, gt, &out);
+    MPI_Group_free(&gf);
+    MPI_Group_free(&gt);
+    return out == MPI_UNDEFINED ? -1 : out;
+}
+
+bool mpi_finalized() {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    return finalized != 0;
+}
+
+}  // namespace
+
+void enable_shared_fields(MPI_Comm comm) {
+    if (field_node() != MPI_COMM_NULL)
+        return;
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &field_node());
+}
+
+void disable_shared_fields() {
+    if (!shared_buffers().empty())
+        throw std::runtime_error("disable_shared_fields: shared fields still allocated");
+    if (field_node() != MPI_COMM_NULL)
+        MPI_Comm_free(&field_node());
+}
+
+bool shared_fields_enabled() { return field_node() != MPI_COMM_NULL; }
+
+const SharedBuffer* find_shared_buffer(const void* p) {
+    for (const SharedBuffer& b : shared_buffers())
+        if (b.base == p)
+            return &b;
+    return nullptr;
+}
+
+void* field_alloc_shared(size_t bytes) {
+    if (!shared_fields_enabled())
+        throw std::runtime_error("FieldLayout::shared requires enable_shared_fields()");
+    // Non-contiguous segments let every rank's buffer start on its own pages, so first touch still
+    // places them on the rank's NUMA node.
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "alloc_shared_noncontig", "true");
+    SharedBuffer b;
+    void* base = nullptr;
+    const int rc = MPI_Win_allocate_shared(static_cast<MPI_Aint>(std::max<size_t>(bytes, 1)), 1,
+                                           info, field_node(), &base, &b.win);
+    MPI_Info_free(&info);
+    if (rc != MPI_SUCCESS)
+        throw std::bad_alloc();
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, b.win);
+    b.id = next_buffer_id++;
+    b.base = static_cast<char*>(base);
+    int size = 1;
+    MPI_Comm_size(field_node(), &size);
+    b.peers.resize(size);
+    for (int r = 0; r < size; ++r) {
+        MPI_Aint seg = 0;
+        int disp = 1;
+        void* p = nullptr;
+        MPI_Win_shared_query(b.win, r, &seg, &disp, &p);
+        b.peers[r] = static_cast<char*>(p);
+    }
+    shared_buffers().push_back(b);
+    return base;
+}
+
+void field_free_shared(void* p) noexcept {
+    auto& buffers = shared_buffers();
+    auto it = std::find_if(buffers.begin(), buffers.end(),
+                           [&](const SharedBuffer& b) { return b.base == p; });
+    if (it == buffers.end())
+        return;
+    // Buffers outliving MPI_Finalize are reclaimed with the process.
+    if (!mpi_finalized()) {
+        MPI_Win_unlock_all(it->win);
+        MPI_Win_free(&it->win);
+    }
+    buffers.erase(it);
+}
+
+struct ShmLinks::Control {
+    ShmGeometry geom;
+    std::atomic<long> flag[3];
+    std::atomic<long> buffer;  // SharedBuffer::id of the buffer in the current exchange, or -1
+};
+
+ShmLinks::ShmLinks(MPI_Comm comm, const int nbrs[4], const ShmGeometry& mine) : comm_(comm) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &node_);
+
+    void* base = nullptr;
+    MPI_Win_allocate_shared(sizeof(Control), 1, MPI_INFO_NULL, node_, &base, &win_);
+    mine_ = new (base) Control;
+    mine_->geom = mine;
+    for (auto& f : mine_->flag) f.store(0, std::memory_order_relaxed);
+    mine_->buffer.store(-1, std::memory_order_relaxed);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, win_);
+
+    // Only neighbors that can map this rank's shared fields are linked.
+    for (int s = 0; s < 4; ++s) {
+        const int field_rank = translate(comm, nbrs[s], field_node());
+        const int ctl_rank = translate(comm, nbrs[s], node_);
+        if (field_rank >= 0 && ctl_rank >= 0) {
+            field_peer_[s] = field_rank;
+            ctl_peer_[s] = ctl_rank;
+        }
+    }
+    MPI_Win_sync(win_);
+    MPI_Barrier(node_);
+    MPI_Win_sync(win_);
+    for (int s = 0; s < 4; ++s) {
+        if (!linked(s))
+            continue;
+        MPI_Aint seg = 0;
+        int disp = 1;
+        void* p = nullptr;
+        MPI_Win_shared_query(win_, ctl_peer_[s], &seg, &disp, &p);
+        peer_ctl_[s] = static_cast<Control*>(p);
+    }
+}
+
+ShmLinks::~ShmLinks() {
+    if (mpi_finalized())
+        return;
+    MPI_Win_unlock_all(win_);
+    MPI_Win_free(&win_);
+    MPI_Comm_free(&node_);
+}
+
+const ShmGeometry& ShmLinks::geometry(int s) const { return peer_ctl_[s]->geom; }
+
+const ShmGeometry& ShmLinks::own_geometry() const { return mine_->geom; }
+
+void ShmLinks::post_ready(const SharedBuffer* buf) {
+    buf_ = buf;
+    ++seq_;
+    // Stores to the field become visible before the flag that announces them.
+    MPI_Win_sync(buf_->win);
+    mine_->buffer.store(buf_->id, std::memory_order_relaxed);
+    post(Ready);
+}
+
+void ShmLinks::post(Flag f) {
+    MPI_Win_sync(win_);
+    mine_->flag[f].store(seq_, std::memory_order_release);
+}
+
+void ShmLinks::spin_until(const std::atomic<long>& flag, long value) const {
+    while (flag.load(std::memory_order_acquire) < value) {
+        // Keeps the off-node messages of this and the other ranks moving.
+        int pending = 0;
+        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, comm_, &pending, MPI_STATUS_IGNORE);
+    }
+    MPI_Win_sync(win_);
+}
+
+const char* ShmLinks::wait(int s, Flag f) {
+    Control* peer = peer_ctl_[s];
+    spin_until(peer->flag[f], seq_);
+    // The neighbor cannot start its next exchange before this one is done, so `buffer` still
+    // belongs to exchange seq_.
+    const long id = peer->buffer.load(std::memory_order_relaxed);
+    if (id != buf_->id)
+        throw std::runtime_error("shm halo exchange: neighbors exchange different buffers");
+    MPI_Win_sync(buf_->win);
+    return buf_->peers[field_peer_[s]];
+}
+
+void ShmLinks::finish() {
+    post(Done);
+    for (int s = 0; s < 4; ++s)
+        if (linked(s))
+            spin_until(peer_ctl_[s]->flag[Done], seq_);
+}
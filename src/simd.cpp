@@ -0,0 +1,393 @@
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#include "field.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CLIMATE_SIM_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+// All variants evaluate the same expressions in the same order and this file is built with
+// -ffp-contract=off (see src/CMakeLists.txt), so every level produces bit-identical results.
+// Loads and stores are unaligned: spans start at the halo offset, not on a vector boundary.
+
+namespace {
+
+void diffuse_scalar(const double* s,
+                    const double* c,
+                    const double* n,
+                    double* out,
+                    int count,
+                    double ax,
+                    double ay) {
+    diffuse_row<double, double>(s, c, n, out, count, ax, ay);
+}
+
+void advect_scalar(const double* xm,
+                   const double* xp,
+                   const double* ym,
+                   const double* yp,
+                   double* out,
+                   int count,
+                   double cx,
+                   double cy) {
+    advect_row<double, double>(xm, xp, ym, yp, out, count, cx, cy);
+}
+
+void advect_diffuse_scalar(const double* s,
+                           const double* c,
+                           const double* n,
+                           const double* ym,
+                           const double* yp,
+                           int ox,
+                           double* out,
+                           int count,
+                           double ax,
+                           double ay,
+                           double cx,
+                           double cy) {
+    advect_diffuse_row<double, double>(s, c, n, ym, yp, ox, out, count, ax, ay, cx, cy);
+}
+
+#ifdef CLIMATE_SIM_X86_DISPATCH
+
+// ---------------------------------------------------------------- SSE2 (2 doubles per vector)
+
+__attribute__((target("sse2"))) void diffuse_sse2(const double* s,
+                                                  const double* c,
+                                                  const double* n,
+                                                  double* out,
+                                                  int count,
+                                                  double ax,
+                                                  double ay) {
+    const __m128d vax = _mm_set1_pd(ax), vay = _mm_set1_pd(ay), two = _mm_set1_pd(2.0);
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d vc = _mm_loadu_pd(c + i);
+        const __m128d c2 = _mm_mul_pd(two, vc);
+        const __m128d tx =
+            _mm_add_pd(_mm_sub_pd(_mm_loadu_pd(c + i + 1), c2), _mm_loadu_pd(c + i - 1));
+        const __m128d ty = _mm_add_pd(_mm_sub_pd(_mm_loadu_pd(n + i), c2), _mm_loadu_pd(s + i));
+        const __m128d r = _mm_add_pd(_mm_add_pd(vc, _mm_mul_pd(vax, tx)), _mm_mul_pd(vay, ty));
+        _mm_storeu_pd(out + i, r);
+    }
+    diffuse_scalar(s + i, c + i, n + i, out + i, count - i, ax, ay);
+}
+
+__attribute__((target("sse2"))) void advect_sse2(const double* xm,
+                                                 const double* xp,
+                                                 const double* ym,
+                                                 const double* yp,
+                                                 double* out,
+                                                 int count,
+                                                 double cx,
+                                                 double cy) {
+    const __m128d vcx = _mm_set1_pd(cx), vcy = _mm_set1_pd(cy);
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d gx = _mm_mul_pd(vcx, _mm_sub_pd(_mm_loadu_pd(xp + i), _mm_loadu_pd(xm + i)));
+        const __m128d gy = _mm_mul_pd(vcy, _mm_sub_pd(_mm_loadu_pd(yp + i), _mm_loadu_pd(ym + i)));
+        _mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(out + i), _mm_add_pd(gx, gy)));
+    }
+    advect_scalar(xm + i, xp + i, ym + i, yp + i, out + i, count - i, cx, cy);
+}
+
+__attribute__((target("sse2"))) void advect_diffuse_sse2(const double* s,
+                                                         const double* c,
+                                                         const double* n,
+                                                         const double* ym,
+                                                         const double* yp,
+                                                         int ox,
+                                                         double* out,
+                                                         int count,
+                                                         double ax,
+                                                         double ay,
+                                                         double cx,
+                                                         double cy) {
+    const __m128d vax = _mm_set1_pd(ax), vay = _mm_set1_pd(ay), two = _mm_set1_pd(2.0);
+    const __m128d vcx = _mm_set1_pd(cx), vcy = _mm_set1_pd(cy);
+    int i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d vc = _mm_loadu_pd(c + i);
+        const __m128d c2 = _mm_mul_pd(two, vc);
+        const __m128d tx =
+            _mm_add_pd(_mm_sub_pd(_mm_loadu_pd(c + i + 1), c2), _mm_loadu_pd(c + i - 1));
+        const __m128d ty = _mm_add_pd(_mm_sub_pd(_mm_loadu_pd(n + i), c2), _mm_loadu_pd(s + i));
+        const __m128d diff = _mm_add_pd(_mm_mul_pd(vax, tx), _mm_mul_pd(vay, ty));
+        const __m128d gx = _mm_mul_pd(
+            vcx, _mm_sub_pd(_mm_loadu_pd(c + i + ox), _mm_loadu_pd(c + i + ox - 1)));
+        const __m128d gy = _mm_mul_pd(vcy, _mm_sub_pd(_mm_loadu_pd(yp + i), _mm_loadu_pd(ym + i)));
+        _mm_storeu_pd(out + i, _mm_sub_pd(_mm_add_pd(vc, diff), _mm_add_pd(gx, gy)));
+    }
+    advect_diffuse_scalar(
+        s + i, c + i, n + i, ym + i, yp + i, ox, out + i, count - i, ax, ay, cx, cy);
+}
+
+// ---------------------------------------------------------------- AVX2 (4 doubles per vector)
+
+__attribute__((target("avx2"))) void diffuse_avx2(const double* s,
+                                                  const double* c,
+                                                  const double* n,
+                                                  double* out,
+                                                  int count,
+                                                  double ax,
+                                                  double ay) {
+    const __m256d vax = _mm256_set1_pd(ax), vay = _mm256_set1_pd(ay), two = _mm256_set1_pd(2.0);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d vc = _mm256_loadu_pd(c + i);
+        const __m256d c2 = _mm256_mul_pd(two, vc);
+        const __m256d tx = _mm256_add_pd(_mm256_sub_pd(_mm256_loadu_pd(c + i + 1), c2),
+                                         _mm256_loadu_pd(c + i - 1));
+        const __m256d ty =
+            _mm256_add_pd(_mm256_sub_pd(_mm256_loadu_pd(n + i), c2), _mm256_loadu_pd(s + i));
+        _mm256_storeu_pd(
+            out + i,
+            _mm256_add_pd(_mm256_add_pd(vc, _mm256_mul_pd(vax, tx)), _mm256_mul_pd(vay, ty)));
+    }
+    diffuse_scalar(s + i, c + i, n + i, out + i, count - i, ax, ay);
+}
+
+__attribute__((target("avx2"))) void advect_avx2(const double* xm,
+                                                 const double* xp,
+                                                 const double* ym,
+                                                 const double* yp,
+                                                 double* out,
+                                                 int count,
+                                                 double cx,
+                                                 double cy) {
+    const __m256d vcx = _mm256_set1_pd(cx), vcy = _mm256_set1_pd(cy);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d gx =
+            _mm256_mul_pd(vcx, _mm256_sub_pd(_mm256_loadu_pd(xp + i), _mm256_loadu_pd(xm + i)));
+        const __m256d gy =
+            _mm256_mul_pd(vcy, _mm256_sub_pd(_mm256_loadu_pd(yp + i), _mm256_loadu_pd(ym + i)));
+        _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(out + i), _mm256_add_pd(gx, gy)));
+    }
+    advect_scalar(xm + i, xp + i, ym + i, yp + i, out + i, count - i, cx, cy);
+}
+
+__attribute__((target("avx2"))) void advect_diffuse_avx2(const double* s,
+                                                         const double* c,
+                                                         const double* n,
+                                                         const double* ym,
+                                                         const double* yp,
+                                                         int ox,
+                                                         double* out,
+                                                         int count,
+                                                         double ax,
+                                                         double ay,
+                                                         double cx,
+                                                         double cy) {
+    const __m256d vax = _mm256_set1_pd(ax), vay = _mm256_set1_pd(ay), two = _mm256_set1_pd(2.0);
+    const __m256d vcx = _mm256_set1_pd(cx), vcy = _mm256_set1_pd(cy);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d vc = _mm256_loadu_pd(c + i);
+        const __m256d c2 = _mm256_mul_pd(two, vc);
+        const __m256d tx = _mm256_add_pd(_mm256_sub_pd(_mm256_loadu_pd(c + i + 1), c2),
+                                         _mm256_loadu_pd(c + i - 1));
+        const __m256d ty =
+            _mm256_add_pd(_mm256_sub_pd(_mm256_loadu_pd(n + i), c2), _mm256_loadu_pd(s + i));
+        const __m256d diff = _mm256_add_pd(_mm256_mul_pd(vax, tx), _mm256_mul_pd(vay, ty));
+        const __m256d gx = _mm256_mul_pd(
+            vcx, _mm256_sub_pd(_mm256_loadu_pd(c + i + ox), _mm256_loadu_pd(c + i + ox - 1)));
+        const __m256d gy =
+            _mm256_mul_pd(vcy, _mm256_sub_pd(_mm256_loadu_pd(yp + i), _mm256_loadu_pd(ym + i)));
+        _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_add_pd(vc, diff), _mm256_add_pd(gx, gy)));
+    }
+    advect_diffuse_scalar(
+        s + i, c + i, n + i, ym + i, yp + i, ox, out + i, count - i, ax, ay, cx, cy);
+}
+
+// ------------------------------------------------------------- AVX-512 (8 doubles per vector)
+// The row remainder runs through the same vector body under a lane mask instead of a scalar
+// tail; masked-off lanes are neither loaded nor stored.
+
+__attribute__((target("avx512f"))) void diffuse_avx512(const double* s,
+                                                       const double* c,
+                                                       const double* n,
+                                                       double* out,
+                                                       int count,
+                                                       double ax,
+                                                       double ay) {
+    const __m512d vax = _mm512_set1_pd(ax), vay = _mm512_set1_pd(ay), two = _mm512_set1_pd(2.0);
+    for (int i = 0; i < count; i += 8) {
+        const int rem = count - i;
+        const __mmask8 m = rem >= 8 ? static_cast<__mmask8>(0xFF)
+                                    : static_cast<__mmask8>((1u << rem) - 1u);
+        const __m512d vc = _mm512_maskz_loadu_pd(m, c + i);
+        const __m512d c2 = _mm512_mul_pd(two, vc);
+        const __m512d tx = _mm512_add_pd(_mm512_sub_pd(_mm512_maskz_loadu_pd(m, c + i + 1), c2),
+                                         _mm512_maskz_loadu_pd(m, c + i - 1));
+        const __m512d ty = _mm512_add_pd(_mm512_sub_pd(_mm512_maskz_loadu_pd(m, n + i), c2),
+                                         _mm512_maskz_loadu_pd(m, s + i));
+        _mm512_mask_storeu_pd(
+            out + i,
+            m,
+            _mm512_add_pd(_mm512_add_pd(vc, _mm512_mul_pd(vax, tx)), _mm512_mul_pd(vay, ty)));
+    }
+}
+
+__attribute__((target("avx512f"))) void advect_avx512(const double* xm,
+                                                      const double* xp,
+                                                      const double* ym,
+                                                      const double* yp,
+                                                      double* out,
+                                                      int count,
+                                                      double cx,
+                                                      double cy) {
+    const __m512d vcx = _mm512_set1_pd(cx), vcy = _mm512_set1_pd(cy);
+    for (int i = 0; i < count; i += 8) {
+        const int rem = count - i;
+        const __mmask8 m = rem >= 8 ? static_cast<__mmask8>(0xFF)
+                                    : static_cast<__mmask8>((1u << rem) - 1u);
+        const __m512d gx = _mm512_mul_pd(
+            vcx, _mm512_sub_pd(_mm512_maskz_loadu_pd(m, xp + i), _mm512_maskz_loadu_pd(m, xm + i)));
+        const __m512d gy = _mm512_mul_pd(
+            vcy, _mm512_sub_pd(_mm512_maskz_loadu_pd(m, yp + i), _mm512_maskz_loadu_pd(m, ym + i)));
+        _mm512_mask_storeu_pd(
+            out + i, m, _mm512_sub_pd(_mm512_maskz_loadu_pd(m, out + i), _mm512_add_pd(gx, gy)));
+    }
+}
+
+__attribute__((target("avx512f"))) void advect_diffuse_avx512(const double* s,
+                                                              const double* c,
+                                                              const double* n,
+                                                              const double* ym,
+                                                              const double* yp,
+                                                              int ox,
+                                                              double* out,
+                                                              int count,
+                                                              double ax,
+                                                              double ay,
+                                                              double cx,
+                                                              double cy) {
+    const __m512d vax = _mm512_set1_pd(ax), vay = _mm512_set1_pd(ay), two = _mm512_set1_pd(2.0);
+    const __m512d vcx = _mm512_set1_pd(cx), vcy = _mm512_set1_pd(cy);
+    for (int i = 0; i < count; i += 8) {
+        const int rem = count - i;
+        const __mmask8 m = rem >= 8 ? static_cast<__mmask8>(0xFF)
+                                    : static_cast<__mmask8>((1u << rem) - 1u);
+        const __m512d vc = _mm512_maskz_loadu_pd(m, c + i);
+        const __m512d c2 = _mm512_mul_pd(two, vc);
+        const __m512d tx = _mm512_add_pd(_mm512_sub_pd(_mm512_maskz_loadu_pd(m, c + i + 1), c2),
+                                         _mm512_maskz_loadu_pd(m, c + i - 1));
+        const __m512d ty = _mm512_add_pd(_mm512_sub_pd(_mm512_maskz_loadu_pd(m, n + i), c2),
+                                         _mm512_maskz_loadu_pd(m, s + i));
+        const __m512d diff = _mm512_add_pd(_mm512_mul_pd(vax, tx), _mm512_mul_pd(vay, ty));
+        const __m512d gx =
+            _mm512_mul_pd(vcx,
+                          _mm512_sub_pd(_mm512_maskz_loadu_pd(m, c + i + ox),
+                                        _mm512_maskz_loadu_pd(m, c + i + ox - 1)));
+        const __m512d gy = _mm512_mul_pd(
+            vcy, _mm512_sub_pd(_mm512_maskz_loadu_pd(m, yp + i), _mm512_maskz_loadu_pd(m, ym + i)));
+        _mm512_mask_storeu_pd(
+            out + i, m, _mm512_sub_pd(_mm512_add_pd(vc, diff), _mm512_add_pd(gx, gy)));
+    }
+}
+
+#endif  // CLIMATE_SIM_X86_DISPATCH
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+SimdLevel& active_level() {
+    static SimdLevel level = detect_simd_level();
+    return level;
+}
+
+}  // namespace
+
+SimdLevel simd_from_string(const std::string& s) {
+    const std::string t = lower(s);
+    if (t == "scalar" || t == "none")
+        return SimdLevel::Scalar;
+    if (t == "sse2")
+        return SimdLevel::SSE2;
+    if (t == "avx2")
+        return SimdLevel::AVX2;
+    if (t == "avx512" || t == "avx-512" || t == "avx512f")
+        return SimdLevel::AVX512;
+    throw std::runtime_error("Unknown SIMD level: " + s);
+}
+
+std::string simd_to_string(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar:
+            return "scalar";
+        case SimdLevel::SSE2:
+            return "sse2";
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::AVX512:
+            return "avx512";
+    }
+    return "scalar";
+}
+
+SimdLevel detect_simd_level() {
+#ifdef CLIMATE_SIM_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel resolve_simd_level(const std::string& requested) {
+    const SimdLevel detected = detect_simd_level();
+    const std::string t = lower(requested);
+    if (t.empty() || t == "auto")
+        return detected;
+    return std::min(simd_from_string(requested), detected);
+}
+
+void set_simd_level(SimdLevel level) { active_level() = std::min(level, detect_simd_level()); }
+
+SimdLevel active_simd_level() { return active_level(); }
+
+const RowKernels& row_kernels(SimdLevel level) {
+    static const RowKernels scalar{diffuse_scalar, advect_scalar, advect_diffuse_scalar};
+#ifdef CLIMATE_SIM_X86_DISPATCH
+    static const RowKernels sse2{diffuse_sse2, advect_sse2, advect_diffuse_sse2};
+    static const RowKernels avx2{diffuse_avx2, advect_avx2, advect_diffuse_avx2};
+    static const RowKernels avx512{diffuse_avx512, advect_avx512, advect_diffuse_avx512};
+    switch (level) {
+        case SimdLevel::SSE2:
+            return sse2;
+        case SimdLevel::AVX2:
+            return avx2;
+        case SimdLevel::AVX512:
+            return avx512;
+        case SimdLevel::Scalar:
+            break;
+    }
+#else
+    (void)level;
+#endif
+    return scalar;
+}
+
+const RowKernels& row_kernels() { return row_kernels(active_level()); }
+
+void set_flush_denormals(bool enable) {
+#ifdef CLIMATE_SIM_X86_DISPATCH
+    const unsigned int ftz_daz = _MM_FLUSH_ZERO_ON | 0x0040u;  // FTZ | DAZ
+    const unsigned int csr = _mm_getcsr();
+    _mm_setcsr(enable ? (csr | ftz_daz) : (csr & ~ftz_daz));
+#else
+    (void)enable;
+#endif
+}
@@ -0,0 +1,164 @@
+#include "stepper.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "advect_diffuse.hpp"
+#include "boundary.hpp"
+
+template <typename T, typename Acc>
+BasicStepper<T, Acc>::BasicStepper(const SimConfig& cfg, const Decomp2D& dec, MPI_Comm comm)
+    : cfg_(cfg), dec_(dec), comm_(comm), depth_(cfg.perf.halo_depth) {
+    check_tile();
+    make_solvers();
+
+    // Single-layer halos only feed the update's own stencil: skip the ghosts it does not read.
+    if (depth_ == 1) {
+        const bool diffuses = cfg.D > 0.0 && !diffusion_split();
+        const bool advects = !(subcycle_ && subcycle_->stiff() == StiffTerm::Advection);
+        sides_ = (diffuses ? kHaloAll : 0u) | (advects ? upwind_sides(cfg.vx, cfg.vy) : 0u);
+    }
+}
+
+template <typename T, typename Acc>
+void BasicStepper<T, Acc>::check_tile() const {
+    if (depth_ > dec_.nx_local || depth_ > dec_.ny_local) {
+        throw std::runtime_error("perf.halo_depth=" + std::to_string(depth_) +
+                                 " exceeds the local tile " + std::to_string(dec_.nx_local) +
+                                 " x " + std::to_string(dec_.ny_local));
+    }
+}
+
+template <typename T, typename Acc>
+void BasicStepper<T, Acc>::make_solvers() {
+    if (cfg_.scheme == TimeScheme::Implicit && cfg_.D > 0.0)
+        implicit_ = std::make_unique<ImplicitDiffusion>(cfg_, dec_, comm_);
+    if (cfg_.scheme == TimeScheme::Rkl2 && cfg_.D > 0.0)
+        rkl2_ = std::make_unique<Rkl2Diffusion<T, Acc>>(cfg_, dec_, comm_);
+    if (cfg_.scheme == TimeScheme::Subcycle)
+        subcycle_ = std::make_unique<Subcycler<T, Acc>>(cfg_, dec_, comm_);
+}
+
+template <typename T, typename Acc>
+void BasicStepper<T, Acc>::reset_decomposition() {
+    if (n_ % depth_ != 0)
+        throw std::runtime_error("reset_decomposition: tiles may only move between exchanges");
+    check_tile();
+    retired_halo_bytes_ = halo_bytes();
+    retired_halo_bytes_on_node_ = halo_bytes_on_node();
+    plan_.reset();
+    make_solvers();
+}
+
+template <typename T, typename Acc>
+bool BasicStepper<T, Acc>::diffusion_split() const {
+    return implicit_ || rkl2_ || (subcycle_ && subcycle_->stiff() == StiffTerm::Diffusion);
+}
+
+template <typename T, typename Acc>
+void BasicStepper<T, Acc>::set_dt(double dt) {
+    cfg_.dt = dt;
+    if (implicit_)
+        implicit_->set_dt(dt);
+    if (rkl2_)
+        rkl2_->set_dt(dt);
+    if (subcycle_)
+        subcycle_->set_dt(dt);
+}
+
+template <typename T, typename Acc>
+long long BasicStepper<T, Acc>::halo_bytes() const {
+    long long b = retired_halo_bytes_ + (plan_ ? plan_->bytes_sent() : 0);
+    if (implicit_)
+        b += implicit_->halo_bytes();
+    if (rkl2_)
+        b += rkl2_->halo_bytes();
+    if (subcycle_)
+        b += subcycle_->halo_bytes();
+    return b;
+}
+
+template <typename T, typename Acc>
+long long BasicStepper<T, Acc>::halo_bytes_on_node() const {
+    long long b = retired_halo_bytes_on_node_ + (plan_ ? plan_->bytes_sent_on_node() : 0);
+    if (implicit_)
+        b += implicit_->halo_bytes_on_node();
+    if (rkl2_)
+        b += rkl2_->halo_bytes_on_node();
+    if (subcycle_)
+        b += subcycle_->halo_bytes_on_node();
+    return b;
+}
+
+template <typename T, typename Acc>
+void BasicStepper<T, Acc>::update(const FieldT<T>& u, FieldT<T>& tmp, const Rect& region) const {
+    double D = cfg_.D, vx = cfg_.vx, vy = cfg_.vy;
+    if (diffusion_split())
+        D = 0.0;
+    else if (subcycle_)
+        vx = vy = 0.0;
+    explicit_update<T, Acc>(u, tmp, D, vx, vy, cfg_.dt, cfg_.perf.fused, region);
+}
+
+template <typename T, typename Acc>
+void BasicStepper<T, Acc>::step(FieldT<T>& u, FieldT<T>& tmp) {
+    const int sub = static_cast<int>(n_ % depth_);
+    const bool exchange = (sub == 0);
+    const Rect region = expanded_interior(u, dec_, depth_ - 1 - sub);
+
+    Rect inner{};
+    PhaseTimes& ph = timings_.phases;
+    if (exchange) {
+        if (!plan_)
+            plan_ = std::make_unique<HaloPlan>(u, dec_, comm_);
+        {
+            ScopedPhase p(ph, Phase::HaloPost);
+            plan_->begin(u, sides_);
+        }
+        if (cfg_.perf.overlap) {
+            ScopedPhase p(ph, Phase::KernelInterior);
+            inner = shrink_rect(interior_rect(u), 1);
+            if (!inner.empty())
+                update(u, tmp, inner);
+        }
+        {
+            ScopedPhase p(ph, Phase::HaloWait);
+            plan_->end();
+        }
+        ++timings_.exchanges;
+    }
+
+    {
+        ScopedPhase p(ph, Phase::Boundary);
+        apply_boundary(u, dec_, cfg_.bc, 0.0);
+        // Ghosts outside the updated region carry over unchanged, as in the single-layer kernels.
+        copy_halo_ring(u, tmp);
+    }
+    {
+        ScopedPhase p(ph, Phase::KernelEdges);
+        for (const Rect& strip : frame_rects(region, inner))
+            if (!strip.empty())
+                update(u, tmp, strip);
+    }
+    {
+        ScopedPhase p(ph, Phase::Swap);
+        std::swap(u.data, tmp.data);
+    }
+    ++n_;
+
+    if (implicit_ || rkl2_ || subcycle_) {
+        ScopedPhase p(ph, Phase::KernelSplit);
+        if (implicit_)
+            timings_.cg_iterations += implicit_->solve(u);
+        else if (rkl2_)
+            rkl2_->advance(u);
+        else
+            subcycle_->advance(u);
+    }
+}
+
+template class BasicStepper<double, double>;
+template class BasicStepper<float, float>;
+template class BasicStepper<float, double>;
@@ -0,0 +1,138 @@
+#include "sts.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "simd.hpp"
+#include "stability.hpp"
+#include "threads.hpp"
+#include "tiling.hpp"
+
+namespace {
+
+// b_j of the RKL2 recursion; b_0 = b_1 = b_2 = 1/3.
+double rkl2_b(int j) { return j < 2 ? 1.0 / 3.0 : (j * j + j - 2.0) / (2.0 * j * (j + 1.0)); }
+
+}  // namespace
+
+int rkl2_stages(double dt, double dt_diff) {
+    const double ratio = dt / dt_diff;
+    const int s = static_cast<int>(std::ceil(0.5 * (std::sqrt(9.0 + 16.0 * ratio) - 1.0)));
+    return std::max(2, s);
+}
+
+template <typename T, typename Acc>
+Rkl2Diffusion<T, Acc>::Rkl2Diffusion(const SimConfig& cfg, const Decomp2D& dec, MPI_Comm comm)
+    : dec_(dec),
+      bc_(cfg.bc),
+      kx_(cfg.D / (cfg.dx * cfg.dx)),
+      ky_(cfg.D / (cfg.dy * cfg.dy)),
+      dt_diff_(safe_dt(cfg.dx, cfg.dy, 0.0, 0.0, cfg.D)),
+      m_(dec.nx_local, dec.ny_local, cfg.perf.halo_depth, cfg.dx, cfg.dy, cfg.tracers),
+      a_(dec.nx_local, dec.ny_local, cfg.perf.halo_depth, cfg.dx, cfg.dy, cfg.tracers),
+      b_(dec.nx_local, dec.ny_local, cfg.perf.halo_depth, cfg.dx, cfg.dy, cfg.tracers),
+      plan_(a_, dec, comm),
+      row_(dec.nx_local * m_.cell_width()),
+      stage_(static_cast<size_t>(max_threads()) * row_) {
+    set_dt(cfg.dt);
+}
+
+template <typename T, typename Acc>
+void Rkl2Diffusion<T, Acc>::set_dt(double dt) {
+    ax_ = kx_ * dt;
+    ay_ = ky_ * dt;
+    s_ = rkl2_stages(dt, dt_diff_);
+}
+
+template <typename T, typename Acc>
+void Rkl2Diffusion<T, Acc>::refresh_ghosts(FieldT<T>& f) {
+    plan_.exchange(f);
+    apply_boundary(f, dec_, bc_, 0.0);
+}
+
+template <typename T, typename Acc>
+void Rkl2Diffusion<T, Acc>::advance(FieldT<T>& u) {
+    const double w1 = 4.0 / (s_ * s_ + s_ - 2.0);
+    const Rect interior = interior_rect(u);
+    const TileShape tiles = active_tile_shape();
+    // Only grows if set_threads raised the thread count after construction.
+    const size_t scratch = static_cast<size_t>(max_threads()) * row_;
+    if (stage_.size() < scratch)
+        stage_.resize(scratch);
+
+    // Stage 1: M0 = dt L(Y0), Y1 = Y0 + w1/3 M0.
+    refresh_ghosts(u);
+    const Acc ax = static_cast<Acc>(ax_), ay = static_cast<Acc>(ay_);
+    const Acc mu1 = static_cast<Acc>(w1 * rkl2_b(1));
+    for_each_tile(interior, tiles, [&](const Rect& t) {
+        for (int j = t.j0; j < t.j1; ++j) {
+            const T* s = u.row(j - 1);
+            const T* c = u.row(j);
+            const T* n = u.row(j + 1);
+            T* m = m_.row(j);
+            T* y1 = a_.row(j);
+            const Acc two = 2;
+#pragma omp simd
+            for (int i = t.i0; i < t.i1; ++i) {
+                const Acc uij = c[i];
+                const Acc lap = ax * (Acc(c[i + 1]) - two * uij + Acc(c[i - 1])) +
+                                ay * (Acc(n[i]) - two * uij + Acc(s[i]));
+                m[i] = static_cast<T>(lap);
+                y1[i] = static_cast<T>(uij + mu1 * lap);
+            }
+        }
+    });
+
+    // Stage j: Y_j = mu_j Y_{j-1} + nu_j Y_{j-2} + (1 - mu_j - nu_j) Y0 + mu~_j dt L(Y_{j-1})
+    //                + gamma~_j M0, with mu~_j = w1 mu_j. The diffusion kernel forms
+    //                Y_{j-1} + w1 dt L(Y_{j-1}) a row at a time; Y_j overwrites Y_{j-2}.
+    const RowOps<T, Acc> k;
+    FieldT<T>* prev2 = &u;
+    FieldT<T>* prev = &a_;
+    for (int j = 2; j <= s_; ++j) {
+        const double bj = rkl2_b(j);
+        const double mu = (2.0 * j - 1.0) / j * bj / rkl2_b(j - 1);
+        const double nu = -(j - 1.0) / j * bj / rkl2_b(j - 2);
+        const Acc c_prev = static_cast<Acc>(mu);
+        const Acc c_prev2 = static_cast<Acc>(nu);
+        const Acc c_y0 = static_cast<Acc>(1.0 - mu - nu);
+        const Acc c_m = static_cast<Acc>(-(1.0 - rkl2_b(j - 1)) * w1 * mu);
+
+        refresh_ghosts(*prev);
+        FieldT<T>& dst = (j == 2) ? b_ : *prev2;
+        const FieldT<T>& y1 = *prev;
+        const FieldT<T>& y2 = *prev2;
+        for_each_tile(interior, tiles, [&](const Rect& t) {
+            const int count = t.i1 - t.i0;
+            T* stage = stage_.data() + static_cast<size_t>(thread_num()) * row_;
+            for (int jj = t.j0; jj < t.j1; ++jj) {
+                k.diffuse(y1.row(jj - 1) + t.i0,
+                          y1.row(jj) + t.i0,
+                          y1.row(jj + 1) + t.i0,
+                          stage,
+                          count,
+                          w1 * ax_,
+                          w1 * ay_);
+                const T* p2 = y2.row(jj) + t.i0;
+                const T* y0 = u.row(jj) + t.i0;
+                const T* m = m_.row(jj) + t.i0;
+                T* out = dst.row(jj) + t.i0;
+#pragma omp simd
+                for (int i = 0; i < count; ++i) {
+                    out[i] = static_cast<T>(c_prev * Acc(stage[i]) + c_prev2 * Acc(p2[i]) +
+                                            c_y0 * Acc(y0[i]) + c_m * Acc(m[i]));
+                }
+            }
+        });
+        prev2 = prev;
+        prev = &dst;
+    }
+
+    std::swap(u.data, prev->data);
+}
+
+template class Rkl2Diffusion<double, double>;
+template class Rkl2Diffusion<float, float>;
+template class Rkl2Diffusion<float, double>;
@@ -0,0 +1,64 @@
+#include "subcycle.hpp"
+
+#include <utility>
+
+#include "advect_diffuse.hpp"
+#include "diffusion.hpp"
+#include "stability.hpp"
+#include "tiling.hpp"
+
+std::string stiff_term_to_string(StiffTerm term) {
+    return term == StiffTerm::Advection ? "advection" : "diffusion";
+}
+
+SubcycleSplit subcycle_split(const SimConfig& cfg, double dt) {
+    SubcycleSplit s;
+    s.dt_adv = advective_dt(cfg.dx, cfg.dy, cfg.vx, cfg.vy);
+    s.dt_diff = diffusive_dt(cfg.dx, cfg.dy, cfg.D);
+    s.stiff = s.dt_adv < s.dt_diff ? StiffTerm::Advection : StiffTerm::Diffusion;
+    s.substeps = substep_count(dt, s.stiff == StiffTerm::Advection ? s.dt_adv : s.dt_diff);
+    return s;
+}
+
+template <typename T, typename Acc>
+Subcycler<T, Acc>::Subcycler(const SimConfig& cfg, const Decomp2D& dec, MPI_Comm comm)
+    : cfg_(cfg),
+      dec_(dec),
+      split_(subcycle_split(cfg, cfg.dt)),
+      dt_(cfg.dt),
+      tmp_(dec.nx_local, dec.ny_local, cfg.perf.halo_depth, cfg.dx, cfg.dy, cfg.tracers),
+      plan_(tmp_, dec, comm) {}
+
+template <typename T, typename Acc>
+void Subcycler<T, Acc>::set_dt(double dt) {
+    dt_ = dt;
+    split_ = subcycle_split(cfg_, dt);
+}
+
+template <typename T, typename Acc>
+void Subcycler<T, Acc>::advance(FieldT<T>& u) {
+    const double h = dt_ / split_.substeps;
+    const Rect interior = interior_rect(u);
+    const TileShape tiles = active_tile_shape();
+    const bool diffusion = split_.stiff == StiffTerm::Diffusion;
+    const unsigned sides = diffusion ? kHaloAll : upwind_sides(cfg_.vx, cfg_.vy);
+    const AdvectDiffuseKernel<T> advect = advect_diffuse_kernel<T, Acc>(cfg_.vx, cfg_.vy);
+    const double cx = h * cfg_.vx / cfg_.dx, cy = h * cfg_.vy / cfg_.dy;
+
+    for (int s = 0; s < split_.substeps; ++s) {
+        plan_.exchange(u, sides);
+        apply_boundary(u, dec_, cfg_.bc, 0.0);
+        copy_halo_ring(u, tmp_);
+        for_each_tile(interior, tiles, [&](const Rect& t) {
+            if (diffusion)
+                diffusion_step<T, Acc>(u, tmp_, cfg_.D, h, t);
+            else
+                advect(u, tmp_, 0.0, 0.0, cx, cy, t);
+        });
+        std::swap(u.data, tmp_.data);
+    }
+}
+
+template class Subcycler<double, double>;
+template class Subcycler<float, float>;
+template class Subcycler<float, double>;
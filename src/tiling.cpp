@@ -0,0 +1,67 @@
+#include "tiling.hpp"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+
+namespace {
+TileShape& active_shape() {
+    static TileShape shape{};
+    return shape;
+}
+
+size_t sysfs_l2_bytes() {
+    std::ifstream in("/sys/devices/system/cpu/cpu0/cache/index2/size");
+    std::string s;
+    if (!(in >> s) || s.empty())
+        return 0;
+    size_t mult = 1;
+    if (s.back() == 'K' || s.back() == 'k')
+        mult = 1024;
+    else if (s.back() == 'M' || s.back() == 'm')
+        mult = 1024 * 1024;
+    try {
+        return static_cast<size_t>(std::stoul(s)) * mult;
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+}  // namespace
+
+size_t l2_cache_bytes() {
+    size_t bytes = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    const long v = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (v > 0)
+        bytes = static_cast<size_t>(v);
+#endif
+    if (bytes == 0)
+        bytes = sysfs_l2_bytes();
+    return bytes > 0 ? bytes : size_t{1} << 20;
+}
+
+TileShape default_tile_shape(int nx, int ny, size_t elem_bytes) {
+    const size_t budget = l2_cache_bytes() / 2;
+    const size_t bytes_per_cell = 2 * elem_bytes;
+
+    // Prefer full rows (long unit-stride sweeps) and split along x only when even a minimal block
+    // of kMinRows rows would not fit the budget.
+    constexpr size_t kMinRows = 4;
+    const size_t max_tx = std::max<size_t>(budget / (bytes_per_cell * kMinRows), 1);
+
+    TileShape t;
+    t.tx = static_cast<int>(std::min<size_t>(std::max(nx, 1), max_tx));
+    const size_t rows = budget / (bytes_per_cell * static_cast<size_t>(t.tx));
+    t.ty = static_cast<int>(std::min<size_t>(std::max(rows, kMinRows), std::max(ny, 1)));
+    return t;
+}
+
+TileShape resolve_tile_shape(int tile_x, int tile_y, int nx, int ny, size_t elem_bytes) {
+    const TileShape def = default_tile_shape(nx, ny, elem_bytes);
+    return {tile_x > 0 ? std::min(tile_x, nx) : def.tx, tile_y > 0 ? std::min(tile_y, ny) : def.ty};
+}
+
+void set_tile_shape(TileShape shape) { active_shape() = shape; }
+
+TileShape active_tile_shape() { return active_shape(); }
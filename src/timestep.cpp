@@ -0,0 +1,81 @@
+#include "timestep.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "stability.hpp"
+
+namespace {
+
+// Clock values within this relative distance of a target are snapped onto it.
+constexpr double kLandingTolerance = 1e-9;
+
+}  // namespace
+
+double local_dt_limit(const SimConfig& cfg) {
+    const double adv = advective_dt(cfg.dx, cfg.dy, cfg.vx, cfg.vy);
+    const double diff = diffusive_dt(cfg.dx, cfg.dy, cfg.D);
+    switch (cfg.scheme) {
+        case TimeScheme::Explicit:
+            return std::min(adv, diff);
+        case TimeScheme::Subcycle:
+            return std::max(adv, diff);
+        case TimeScheme::Implicit:
+        case TimeScheme::Rkl2:
+            return adv;
+    }
+    return adv;
+}
+
+TimeController::TimeController(const SimConfig& cfg, MPI_Comm comm)
+    : cfg_(cfg),
+      comm_(comm),
+      adaptive_(cfg.adaptive_dt),
+      dt_(cfg.dt),
+      cfl_(cfg.cfl),
+      refresh_every_(cfg.dt_every),
+      steps_(cfg.steps),
+      out_every_(cfg.out_every),
+      t_end_(cfg.steps * cfg.dt) {}
+
+bool TimeController::done() const { return adaptive_ ? t_ >= t_end_ : n_ >= steps_; }
+
+bool TimeController::output_due() const {
+    if (!adaptive_)
+        return n_ % out_every_ == 0 && outputs_ * out_every_ <= n_;
+    return t_ < t_end_ && t_ >= output_time(outputs_);
+}
+
+double TimeController::next_target() const {
+    return std::min(output_time(outputs_ + (output_due() ? 1 : 0)), t_end_);
+}
+
+double TimeController::next_dt() {
+    if (!adaptive_)
+        return dt_;
+
+    if (n_ % refresh_every_ == 0) {
+        const double local = local_dt_limit(cfg_);
+        double global = 0.0;
+        MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_MIN, comm_);
+        limit_ = cfl_ * global;
+    }
+    const double remaining = next_target() - t_;
+    if (!(limit_ < remaining))
+        return remaining;
+    return remaining / std::ceil(remaining / limit_);
+}
+
+void TimeController::advance(double dt) {
+    min_dt_ = n_ == 0 ? dt : std::min(min_dt_, dt);
+    max_dt_ = std::max(max_dt_, dt);
+    ++n_;
+    if (!adaptive_) {
+        t_ = n_ * dt_;
+        return;
+    }
+    const double target = next_target();
+    t_ += dt;
+    if (std::abs(t_ - target) <= kLandingTolerance * std::max(1.0, std::abs(target)))
+        t_ = target;
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "advect_diffuse.hpp"
+#include "advection.hpp"
+#include "diffusion.hpp"
+#include "field.hpp"
+
+static Field make_ramp(int nx, int ny, int halo) {
+    Field f(nx, ny, halo, 1.0, 0.5);
+    for (int j = 0; j < f.ny_total(); ++j)
+        for (int i = 0; i < f.nx_total(); ++i) f.at(i, j) = 0.01 * (i * i) + 0.1 * j + (i ^ j);
+    return f;
+}
+
+static void expect_matches_reference(double D, double vx, double vy, int halo) {
+    const int nx = 7, ny = 5;
+    const double dt = 0.05;
+    Field u = make_ramp(nx, ny, halo);
+
+    Field ref(nx, ny, halo, u.dx, u.dy);
+    std::copy(u.data.begin(), u.data.end(), ref.data.begin());
+    diffusion_step(u, ref, D, dt);
+    advection_step(u, ref, vx, vy, dt);
+
+    Field fused(nx, ny, halo, u.dx, u.dy);
+    fused.fill(-123.0);
+    advect_diffuse_step(u, fused, D, vx, vy, dt);
+
+    for (int j = 0; j < u.ny_total(); ++j)
+        for (int i = 0; i < u.nx_total(); ++i)
+            EXPECT_NEAR(fused.at(i, j), ref.at(i, j), 1e-12) << "at (" << i << "," << j << ")";
+}
+
+TEST(Unit_AdvectDiffuse, MatchesReferencePositiveVelocity) {
+    expect_matches_reference(0.2, 0.7, 0.4, 1);
+}
+
+TEST(Unit_AdvectDiffuse, MatchesReferenceNegativeVelocity) {
+    expect_matches_reference(0.2, -0.7, -0.4, 1);
+}
+
+TEST(Unit_AdvectDiffuse, CopiesFullHaloRing) { expect_matches_reference(0.1, 0.3, -0.2, 2); }
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <mpi.h>
 
+#include <stdexcept>
+#include <vector>
+
 #include "decomp.hpp"
 
 TEST(Unit_Decomp, GridDimsAndNeighbors) {
@@ -34,6 +37,87 @@ TEST(Unit_Decomp, GridDimsAndNeighbors) {
     d.finalize();
 }
 
+TEST(Unit_Decomp, CutsMatchLocalExtent) {
+    Decomp2D d;
+    d.init(MPI_COMM_WORLD, 17, 13);
+    ASSERT_EQ(static_cast<int>(d.x_cuts.size()), d.dims[0] + 1);
+    ASSERT_EQ(static_cast<int>(d.y_cuts.size()), d.dims[1] + 1);
+    EXPECT_EQ(d.x_cuts[d.coords[0]], d.x_offset);
+    EXPECT_EQ(d.y_cuts[d.coords[1]], d.y_offset);
+    EXPECT_EQ(d.x_cuts[d.coords[0] + 1] - d.x_offset, d.nx_local);
+    EXPECT_EQ(d.y_cuts[d.coords[1] + 1] - d.y_offset, d.ny_local);
+    EXPECT_EQ(d.x_cuts.back(), 17);
+    EXPECT_EQ(d.y_cuts.back(), 13);
+
+    // Move the first interior cut one column to the right.
+    std::vector<int> xc = d.x_cuts;
+    if (d.dims[0] > 1)
+        ++xc[1];
+    d.set_cuts(xc, d.y_cuts);
+    EXPECT_EQ(d.x_offset, xc[d.coords[0]]);
+    EXPECT_EQ(d.nx_local, xc[d.coords[0] + 1] - xc[d.coords[0]]);
+
+    std::vector<int> bad = d.x_cuts;
+    bad.back() = 16;
+    EXPECT_THROW(d.set_cuts(bad, d.y_cuts), std::runtime_error);
+    d.finalize();
+}
+
+TEST(Unit_Decomp, NodeGridMinimizesInterNodeSurface) {
+    // Two nodes side by side cut the short edge once; within them 2 x 2 blocks beat 4 x 1 strips.
+    NodeGrid g = choose_node_grid(2, 4, 96, 32);
+    EXPECT_EQ(g.dims[0], 4);
+    EXPECT_EQ(g.dims[1], 2);
+    EXPECT_EQ(g.block[0], 2);
+    EXPECT_EQ(g.block[1], 2);
+
+    g = choose_node_grid(4, 4, 64, 64);
+    EXPECT_EQ(g.dims[0] * g.dims[1], 16);
+    EXPECT_EQ(g.dims[0], 4);
+    EXPECT_EQ(g.block[0] * g.block[1], 4);
+
+    // Tiles must not be empty: a 2-column grid only fits one process column.
+    g = choose_node_grid(1, 4, 2, 100);
+    EXPECT_EQ(g.dims[0], 1);
+    EXPECT_EQ(g.dims[1], 4);
+}
+
+TEST(Unit_Decomp, NodeAwareGridKeepsNodesTogether) {
+    int size = 0, rank = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    // Pairs of consecutive ranks stand in for nodes.
+    const int per_node = size % 2 == 0 ? 2 : 1;
+
+    Decomp2D d;
+    d.init_node_aware(MPI_COMM_WORLD, 32, 24, per_node);
+    ASSERT_EQ(d.dims[0] * d.dims[1], size);
+    EXPECT_EQ(d.nodes, size / per_node);
+    EXPECT_EQ(d.node_block[0] * d.node_block[1], per_node);
+    EXPECT_EQ(d.x_cuts.back(), 32);
+    EXPECT_EQ(d.y_cuts.back(), 24);
+
+    // Rank in MPI_COMM_WORLD of every cart rank, to check the placement.
+    std::vector<int> world(size);
+    MPI_Allgather(&rank, 1, MPI_INT, world.data(), 1, MPI_INT, d.cart_comm);
+    auto same_node = [&](int nbr) {
+        return nbr != MPI_PROC_NULL && world[nbr] / per_node == rank / per_node;
+    };
+    EXPECT_EQ(d.lr_on_node[0], same_node(d.nbr_lr[0]));
+    EXPECT_EQ(d.lr_on_node[1], same_node(d.nbr_lr[1]));
+    EXPECT_EQ(d.du_on_node[0], same_node(d.nbr_du[0]));
+    EXPECT_EQ(d.du_on_node[1], same_node(d.nbr_du[1]));
+
+    // Every node fills exactly one node block.
+    const int block = d.coords[0] / d.node_block[0] +
+                      (d.dims[0] / d.node_block[0]) * (d.coords[1] / d.node_block[1]);
+    std::vector<int> blocks(size);
+    MPI_Allgather(&block, 1, MPI_INT, blocks.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    for (int r = 0; r < size; ++r)
+        EXPECT_EQ(blocks[r] == block, r / per_node == rank / per_node) << "rank " << r;
+    d.finalize();
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     MPI_Init(&argc, &argv);
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <cstdint>
+
 #include "field.hpp"
 
 TEST(Unit_Field, AllocationAndSize) {
@@ -24,3 +26,84 @@ TEST(Unit_Field, OutOfBoundsThrows) {
     EXPECT_THROW((void)f.at(f.nx_total(), 0), std::out_of_range);
     EXPECT_THROW((void)f.at(0, f.ny_total()), std::out_of_range);
 }
+
+TEST(Unit_Field, RowAndViewMatchAt) {
+    Field f(3, 2, 1, 1.0, 1.0);
+    for (int j = 0; j < f.ny_total(); ++j)
+        for (int i = 0; i < f.nx_total(); ++i) f.at(i, j) = 10 * j + i;
+
+    const Field& cf = f;
+    ConstFieldView v = cf.view();
+    for (int j = 0; j < f.ny_total(); ++j) {
+        EXPECT_EQ(f.row(j), &f.at(0, j));
+        for (int i = 0; i < f.nx_total(); ++i) {
+            EXPECT_DOUBLE_EQ(cf.row(j)[i], f.at(i, j));
+            EXPECT_DOUBLE_EQ(v(i, j), f.at(i, j));
+        }
+    }
+
+    f.view()(2, 1) = -1.0;
+    EXPECT_DOUBLE_EQ(f.at(2, 1), -1.0);
+}
+
+TEST(Unit_Field, PaddedLayoutAlignsInteriorRows) {
+    for (int h : {1, 2, 3}) {
+        Field f(13, 5, h, 1.0, 1.0, FieldLayout{true, false});
+        EXPECT_EQ(f.pitch % 8, 0);
+        EXPECT_GE(f.pitch, f.nx_total());
+        for (int j = 0; j < f.ny_total(); ++j) {
+            const auto addr = reinterpret_cast<std::uintptr_t>(f.row(j) + h);
+            EXPECT_EQ(addr % kFieldAlignment, 0u) << "h=" << h << " row " << j;
+            EXPECT_EQ(f.row(j), &f.at(0, j));
+        }
+
+        f.at(f.nx_total() - 1, 2) = 7.0;
+        EXPECT_DOUBLE_EQ(f.view()(f.nx_total() - 1, 2), 7.0);
+        EXPECT_DOUBLE_EQ(f.row(3)[0], 0.0);
+    }
+
+    FieldF f32(13, 5, 1, 1.0, 1.0, FieldLayout{true, false});
+    EXPECT_EQ(f32.pitch % 16, 0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(f32.row(2) + 1) % kFieldAlignment, 0u);
+
+    Field plain(13, 5, 1, 1.0, 1.0, FieldLayout{});
+    EXPECT_EQ(plain.pitch, plain.nx_total());
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(plain.data.data()) % kFieldAlignment, 0u);
+}
+
+TEST(Unit_Field, TracerLayouts) {
+    Field planes(5, 4, 1, 1.0, 1.0, Tracers{3, TracerLayout::Planes});
+    EXPECT_EQ(planes.planes(), 3);
+    EXPECT_EQ(planes.cell_width(), 1);
+    EXPECT_EQ(planes.plane, static_cast<size_t>(planes.pitch) * planes.ny_total());
+    EXPECT_EQ(&planes.at(2, 1, 2), planes.row(1, 2) + 2);
+
+    Field cells(5, 4, 1, 1.0, 1.0, Tracers{3, TracerLayout::Interleaved});
+    EXPECT_EQ(cells.planes(), 1);
+    EXPECT_EQ(cells.cell_width(), 3);
+    EXPECT_GE(cells.pitch, 3 * cells.nx_total());
+    EXPECT_EQ(&cells.at(2, 1, 2), cells.row(1) + 2 * 3 + 2);
+    EXPECT_THROW(cells.at(0, 0, 3), std::out_of_range);
+    EXPECT_DEBUG_DEATH((void)cells.view(), "cell_width");
+    Field one(5, 4, 1, 1.0, 1.0, Tracers{1, TracerLayout::Interleaved});
+    EXPECT_EQ(&one.view()(2, 1), &one.at(2, 1));
+
+    for (Field* f : {&planes, &cells}) {
+        for (int k = 0; k < 3; ++k)
+            for (int j = 0; j < f->ny_total(); ++j)
+                for (int i = 0; i < f->nx_total(); ++i) f->at(i, j, k) = 100 * k + 10 * j + i;
+        Field dst(5, 4, 1, 1.0, 1.0, f->tracer);
+        copy_halo_ring(*f, dst);
+        EXPECT_DOUBLE_EQ(dst.at(0, 2, 1), f->at(0, 2, 1));
+        EXPECT_DOUBLE_EQ(dst.at(6, 3, 2), f->at(6, 3, 2));
+        EXPECT_DOUBLE_EQ(dst.at(3, 0, 2), f->at(3, 0, 2));
+        EXPECT_DOUBLE_EQ(dst.at(3, 2, 2), 0.0);  // interior untouched
+    }
+
+    const Tracers aos{3, TracerLayout::Interleaved};
+    Field padded(5, 4, 2, 1.0, 1.0, aos, FieldLayout{true, false});
+    for (int j = 0; j < padded.ny_total(); ++j) {
+        const auto addr = reinterpret_cast<std::uintptr_t>(&padded.at(2, j));
+        EXPECT_EQ(addr % kFieldAlignment, 0u) << "row " << j;
+    }
+}
@@ -1,26 +1,21 @@
 #include <gtest/gtest.h>
 #include <mpi.h>
 
+#include <utility>
+
+#include "allocator.hpp"
 #include "decomp.hpp"
 #include "field.hpp"
 #include "halo.hpp"
+#include "shm.hpp"
 
 TEST(Unit_Halo, AdaptiveFaces) {
-    int init = 0;
-    MPI_Initialized(&init);
-    if (!init) {
-        int prov = 0;
-        MPI_Init_thread(nullptr, nullptr, MPI_THREAD_FUNNELED, &prov);
-    }
-
     int rank = 0, size = 0;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    if (size < 2) {
-        MPI_Finalize();
+    if (size < 2)
         GTEST_SKIP() << "requires at least 2 ranks";
-    }
 
     const int NXG = 8, NYG = 8;
     Decomp2D dec;
@@ -56,8 +51,257 @@ TEST(Unit_Halo, AdaptiveFaces) {
     }
 
     dec.finalize();
-    int fin = 0;
-    MPI_Finalized(&fin);
-    if (!fin)
-        MPI_Finalize();
+}
+
+// Every ghost cell facing a neighbor, corners included, must hold the neighbor's interior value
+// of a globally unique function when the halo is deeper than one layer.
+TEST(Unit_Halo, DeepHaloIncludingCorners) {
+    int rank = 0, size = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (size < 2)
+        GTEST_SKIP() << "requires at least 2 ranks";
+
+    const int NXG = 24, NYG = 20;
+    Decomp2D dec;
+    dec.init(MPI_COMM_WORLD, NXG, NYG);
+
+    const int h = 3;
+    Field f(dec.nx_local, dec.ny_local, h, 1.0, 1.0);
+    auto global = [](int gi, int gj) { return static_cast<double>(gi + 1000 * gj); };
+
+    f.fill(-1.0);
+    for (int j = h; j < h + dec.ny_local; ++j)
+        for (int i = h; i < h + dec.nx_local; ++i)
+            f.at(i, j) = global(dec.x_offset + i - h, dec.y_offset + j - h);
+
+    exchange_halos(f, dec, MPI_COMM_WORLD);
+
+    const Rect r = expanded_interior(f, dec, h);
+    for (int j = r.j0; j < r.j1; ++j)
+        for (int i = r.i0; i < r.i1; ++i)
+            EXPECT_EQ(f.at(i, j), global(dec.x_offset + i - h, dec.y_offset + j - h))
+                << "ghost (" << i << "," << j << ") on rank " << rank;
+
+    dec.finalize();
+}
+
+// A plan reused across the two swapped buffers of a time loop must keep exchanging the
+// current contents of whichever buffer it is handed.
+TEST(Unit_Halo, PlanReusedAcrossSwappedBuffers) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (size < 2)
+        GTEST_SKIP() << "requires at least 2 ranks";
+
+    const int NXG = 16, NYG = 12;
+    Decomp2D dec;
+    dec.init(MPI_COMM_WORLD, NXG, NYG);
+
+    for (int h : {1, 2}) {
+        Field a(dec.nx_local, dec.ny_local, h, 1.0, 1.0);
+        Field b(dec.nx_local, dec.ny_local, h, 1.0, 1.0);
+        HaloPlan plan(a, dec, MPI_COMM_WORLD);
+
+        for (int it = 0; it < 5; ++it) {
+            auto global = [it](int gi, int gj) { return static_cast<double>(gi + 100 * gj + it); };
+            a.fill(-1.0);
+            for (int j = h; j < h + dec.ny_local; ++j)
+                for (int i = h; i < h + dec.nx_local; ++i)
+                    a.at(i, j) = global(dec.x_offset + i - h, dec.y_offset + j - h);
+
+            plan.begin(a);
+            plan.end();
+
+            // A single layer skips the corners, which the 5-point stencil never reads.
+            const Rect r = expanded_interior(a, dec, h);
+            const Rect in = interior_rect(a);
+            int mismatches = 0;
+            for (int j = r.j0; j < r.j1; ++j)
+                for (int i = r.i0; i < r.i1; ++i) {
+                    const bool corner = (i < in.i0 || i >= in.i1) && (j < in.j0 || j >= in.j1);
+                    if (h == 1 && corner)
+                        continue;
+                    if (a.at(i, j) != global(dec.x_offset + i - h, dec.y_offset + j - h))
+                        ++mismatches;
+                }
+            EXPECT_EQ(mismatches, 0) << "h=" << h << " it=" << it;
+            std::swap(a.data, b.data);
+        }
+    }
+
+    dec.finalize();
+}
+
+// A partial exchange fills exactly the requested ghost sides and leaves the others untouched.
+TEST(Unit_Halo, SideMaskFillsOnlyRequestedGhosts) {
+    int rank = 0, size = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (size < 2)
+        GTEST_SKIP() << "requires at least 2 ranks";
+
+    Decomp2D dec;
+    dec.init(MPI_COMM_WORLD, 16, 12);
+    Field f(dec.nx_local, dec.ny_local, 1, 1.0, 1.0);
+    HaloPlan plan(f, dec, MPI_COMM_WORLD);
+    const int nx = dec.nx_local, ny = dec.ny_local;
+
+    for (unsigned sides : {kHaloLeft | kHaloDown, kHaloRight | kHaloUp, 0u}) {
+        f.fill(-1.0);
+        for (int j = 1; j <= ny; ++j)
+            for (int i = 1; i <= nx; ++i) f.at(i, j) = rank;
+        plan.exchange(f, sides);
+
+        auto expect = [&](unsigned side, int nbr, double ghost) {
+            const double want = (sides & side) && nbr != MPI_PROC_NULL ? nbr : -1.0;
+            EXPECT_EQ(ghost, want) << "sides=" << sides << " side=" << side;
+        };
+        expect(kHaloLeft, dec.nbr_lr[0], f.at(0, 1));
+        expect(kHaloRight, dec.nbr_lr[1], f.at(nx + 1, 1));
+        expect(kHaloDown, dec.nbr_du[0], f.at(1, 0));
+        expect(kHaloUp, dec.nbr_du[1], f.at(1, ny + 1));
+    }
+
+    EXPECT_EQ(upwind_sides(1.0, -2.0), kHaloLeft | kHaloUp);
+    EXPECT_EQ(upwind_sides(-1.0, 0.0), static_cast<unsigned>(kHaloRight));
+    EXPECT_EQ(upwind_sides(0.0, 0.0), 0u);
+    dec.finalize();
+}
+
+TEST(Unit_Halo, SendBytesCountNeighborFaces) {
+    Decomp2D dec;
+    dec.init(MPI_COMM_WORLD, 16, 12);
+    Field f(dec.nx_local, dec.ny_local, 1, 1.0, 1.0);
+    HaloPlan plan(f, dec, MPI_COMM_WORLD);
+    const int nx = dec.nx_local, ny = dec.ny_local;
+    auto has = [](int nbr) { return nbr != MPI_PROC_NULL ? 1 : 0; };
+
+    const long long cols = has(dec.nbr_lr[0]) + has(dec.nbr_lr[1]);
+    const long long rows = has(dec.nbr_du[0]) + has(dec.nbr_du[1]);
+    const long long all = (cols * ny + rows * (nx + 2)) * sizeof(double);
+    EXPECT_EQ(plan.send_bytes(), all);
+    // Filling the left ghosts everywhere means sending to the right neighbor.
+    EXPECT_EQ(plan.send_bytes(kHaloLeft), has(dec.nbr_lr[1]) * ny * sizeof(double));
+
+    EXPECT_EQ(plan.bytes_sent(), 0);
+    plan.exchange(f);
+    plan.exchange(f, kHaloLeft);
+    EXPECT_EQ(plan.bytes_sent(), all + plan.send_bytes(kHaloLeft));
+    // Every rank of this test shares one node.
+    EXPECT_EQ(plan.bytes_sent_on_node(), plan.bytes_sent());
+    dec.finalize();
+}
+
+namespace {
+
+// Exchanges the same data through a `backend` plan (fields allocated with `shared`) and a p2p
+// plan, for both tracer layouts and halo depths 1 and 2, and expects identical ghosts. Returns
+// the bytes the backend plans sent as messages.
+long long expect_backend_matches_p2p(HaloBackend backend, bool shared) {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    // Uneven tiles, so left and right neighbors differ in width and pitch.
+    Decomp2D dec;
+    dec.init(MPI_COMM_WORLD, 21, 15);
+    auto global = [](int gi, int gj, int k, int it) {
+        return static_cast<double>(gi + 100 * gj + 10000 * k + it);
+    };
+
+    long long sent = 0;
+    for (TracerLayout layout : {TracerLayout::Planes, TracerLayout::Interleaved}) {
+        for (int h : {1, 2}) {
+            const Tracers tr{2, layout};
+            set_halo_backend(backend);
+            set_field_layout(FieldLayout{true, false, shared});
+            Field a(dec.nx_local, dec.ny_local, h, 1.0, 1.0, tr);
+            Field b(dec.nx_local, dec.ny_local, h, 1.0, 1.0, tr);
+            HaloPlan plan(a, dec, MPI_COMM_WORLD);
+            set_halo_backend(HaloBackend::P2P);
+            set_field_layout(FieldLayout{true, false, false});
+            Field ref(dec.nx_local, dec.ny_local, h, 1.0, 1.0, tr);
+            HaloPlan p2p(ref, dec, MPI_COMM_WORLD);
+
+            for (int it = 0; it < 3; ++it) {
+                a.fill(-1.0);
+                ref.fill(-1.0);
+                for (int k = 0; k < 2; ++k)
+                    for (int j = h; j < h + dec.ny_local; ++j)
+                        for (int i = h; i < h + dec.nx_local; ++i)
+                            a.at(i, j, k) = ref.at(i, j, k) =
+                                global(dec.x_offset + i - h, dec.y_offset + j - h, k, it);
+                plan.exchange(a);
+                p2p.exchange(ref);
+
+                // A single layer leaves the corners alone, which the 5-point stencil never reads.
+                const Rect in = interior_rect(a);
+                int mismatches = 0;
+                for (int k = 0; k < 2; ++k)
+                    for (int j = 0; j < a.ny_total(); ++j)
+                        for (int i = 0; i < a.nx_total(); ++i) {
+                            const bool corner =
+                                (i < in.i0 || i >= in.i1) && (j < in.j0 || j >= in.j1);
+                            if (!(h == 1 && corner) && a.at(i, j, k) != ref.at(i, j, k))
+                                ++mismatches;
+                        }
+                EXPECT_EQ(mismatches, 0) << halo_backend_to_string(backend) << " h=" << h
+                                         << " it=" << it << " rank " << rank;
+                std::swap(a.data, b.data);
+            }
+            sent += plan.bytes_sent();
+            if (backend == HaloBackend::Shm) {
+                EXPECT_EQ(plan.send_bytes(), 0);
+            } else if (h == 1) {
+                // Single-layer rows skip the corner ghosts.
+                EXPECT_LE(plan.bytes_sent(), p2p.bytes_sent());
+            } else {
+                EXPECT_EQ(plan.bytes_sent(), p2p.bytes_sent());
+            }
+        }
+    }
+    set_field_layout(FieldLayout{});
+    dec.finalize();
+    return sent;
+}
+
+}  // namespace
+
+// The shm backend fills the same ghosts as p2p and sends no messages to neighbors on the same
+// node.
+TEST(Unit_Halo, ShmBackendMatchesP2P) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (size < 2)
+        GTEST_SKIP() << "requires at least 2 ranks";
+
+    enable_shared_fields(MPI_COMM_WORLD);
+    // Every rank of this test shares one node, so no strip travels as a message.
+    EXPECT_EQ(expect_backend_matches_p2p(HaloBackend::Shm, true), 0);
+    disable_shared_fields();
+}
+
+TEST(Unit_Halo, RmaBackendMatchesP2P) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (size < 2)
+        GTEST_SKIP() << "requires at least 2 ranks";
+
+    expect_backend_matches_p2p(HaloBackend::Rma, false);
+}
+
+TEST(Unit_Halo, NeighborBackendMatchesP2P) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (size < 2)
+        GTEST_SKIP() << "requires at least 2 ranks";
+
+    expect_backend_matches_p2p(HaloBackend::Neighbor, false);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    const int rc = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return rc;
 }
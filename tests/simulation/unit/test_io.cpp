@@ -8,6 +8,7 @@
 
 #include "decomp.hpp"
 #include "field.hpp"
+#include "halo.hpp"
 #include "init.hpp"
 #include "io.hpp"
 
@@ -165,6 +166,128 @@ TEST(Unit_IO_CLI, MergedConfigNoYaml) {
     EXPECT_EQ(cfg.ny, 8);
 }
 
+TEST(Unit_IO_CLI, PerfFlags) {
+    SimConfig def = merged_config(std::nullopt, {});
+    EXPECT_FALSE(def.perf.fused);
+
+    SimConfig on = merged_config(std::nullopt, {"--perf.fused=true"});
+    EXPECT_TRUE(on.perf.fused);
+
+    SimConfig bare = merged_config(std::nullopt, {"--perf.fused", "--nx=8"});
+    EXPECT_TRUE(bare.perf.fused);
+    EXPECT_EQ(bare.nx, 8);
+
+    EXPECT_THROW({ merged_config(std::nullopt, {"--perf.fused=maybe"}); }, std::runtime_error);
+
+    EXPECT_EQ(def.perf.halo_depth, 1);
+    EXPECT_EQ(merged_config(std::nullopt, {"--perf.halo_depth=3"}).perf.halo_depth, 3);
+    EXPECT_THROW({ merged_config(std::nullopt, {"--perf.halo_depth=0"}); }, std::runtime_error);
+
+    EXPECT_EQ(def.precision, Precision::Double);
+    EXPECT_EQ(merged_config(std::nullopt, {"--precision=mixed"}).precision, Precision::Mixed);
+    EXPECT_EQ(merged_config(std::nullopt, {"--precision", "float"}).precision, Precision::Float);
+    EXPECT_THROW({ merged_config(std::nullopt, {"--precision=half"}); }, std::runtime_error);
+
+    EXPECT_TRUE(def.perf.overlap);
+    EXPECT_FALSE(merged_config(std::nullopt, {"--perf.overlap=false"}).perf.overlap);
+
+    EXPECT_TRUE(def.perf.phase_report.empty());
+    EXPECT_EQ(merged_config(std::nullopt, {"--perf.phase_report=phases.csv"}).perf.phase_report,
+              "phases.csv");
+}
+
+TEST(Unit_IO_CLI, ReportFlags) {
+    SimConfig def = merged_config(std::nullopt, {});
+    EXPECT_TRUE(def.report.empty());
+    EXPECT_EQ(def.report_path, "outputs/report.json");
+
+    SimConfig on = merged_config(std::nullopt, {"--report=json", "--report_path", "r/run.json"});
+    EXPECT_EQ(on.report, "json");
+    EXPECT_EQ(on.report_path, "r/run.json");
+    EXPECT_EQ(merged_config(std::nullopt, {"--output.report=json"}).report, "json");
+    EXPECT_THROW({ merged_config(std::nullopt, {"--report=xml"}); }, std::runtime_error);
+}
+
+TEST(Unit_IO_CLI, DecompFlags) {
+    SimConfig def = merged_config(std::nullopt, {});
+    EXPECT_EQ(def.decomp.rebalance_every, 0);
+    EXPECT_DOUBLE_EQ(def.decomp.rebalance_tol, 0.05);
+
+    SimConfig on = merged_config(std::nullopt,
+                                 {"--decomp.rebalance_every=50", "--decomp.rebalance_tol", "0.2"});
+    EXPECT_EQ(on.decomp.rebalance_every, 50);
+    EXPECT_FALSE(on.decomp.node_aware);
+    SimConfig node = merged_config(std::nullopt,
+                                   {"--decomp.node_aware=true", "--decomp.ranks_per_node=8"});
+    EXPECT_TRUE(node.decomp.node_aware);
+    EXPECT_EQ(node.decomp.ranks_per_node, 8);
+    EXPECT_THROW({ merged_config(std::nullopt, {"--decomp.ranks_per_node=-2"}); },
+                 std::runtime_error);
+    EXPECT_DOUBLE_EQ(on.decomp.rebalance_tol, 0.2);
+    EXPECT_THROW({ merged_config(std::nullopt, {"--decomp.rebalance_every=-1"}); },
+                 std::runtime_error);
+    EXPECT_THROW(
+        { merged_config(std::nullopt, {"--decomp.rebalance_every=5", "--perf.halo_depth=2"}); },
+        std::runtime_error);
+}
+
+TEST(Unit_IO_CLI, HaloBackendFlag) {
+    EXPECT_EQ(merged_config(std::nullopt, {}).perf.halo_backend, "p2p");
+    EXPECT_EQ(merged_config(std::nullopt, {"--perf.halo_backend=shm"}).perf.halo_backend, "shm");
+    EXPECT_THROW({ merged_config(std::nullopt, {"--perf.halo_backend=udp"}); }, std::runtime_error);
+    EXPECT_EQ(halo_backend_from_string("SHM"), HaloBackend::Shm);
+    EXPECT_EQ(halo_backend_from_string("rma"), HaloBackend::Rma);
+    EXPECT_EQ(halo_backend_to_string(HaloBackend::Neighbor), "neighbor");
+    EXPECT_EQ(halo_backend_to_string(HaloBackend::P2P), "p2p");
+}
+
+TEST(Unit_IO_CLI, TimeSchemeFlags) {
+    SimConfig def = merged_config(std::nullopt, {});
+    EXPECT_EQ(def.scheme, TimeScheme::Explicit);
+
+    SimConfig imp =
+        merged_config(std::nullopt, {"--time.scheme=implicit", "--time.cg_tol", "1e-9"});
+    EXPECT_EQ(imp.scheme, TimeScheme::Implicit);
+    EXPECT_DOUBLE_EQ(imp.cg_tol, 1e-9);
+    EXPECT_EQ(merged_config(std::nullopt, {"--time.cg_max_iter=40"}).cg_max_iter, 40);
+
+    EXPECT_EQ(merged_config(std::nullopt, {"--time.scheme=rkl2"}).scheme, TimeScheme::Rkl2);
+    EXPECT_THROW({ merged_config(std::nullopt, {"--time.scheme=crank"}); }, std::runtime_error);
+    EXPECT_THROW(
+        { merged_config(std::nullopt, {"--time.scheme=implicit", "--perf.halo_depth=2"}); },
+        std::runtime_error);
+}
+
+TEST(Unit_IO_CLI, AdaptiveDtFlags) {
+    SimConfig def = merged_config(std::nullopt, {});
+    EXPECT_FALSE(def.adaptive_dt);
+
+    SimConfig cfg = merged_config(std::nullopt,
+                                  {"--time.adaptive", "--time.cfl=0.5", "--time.dt_every", "4"});
+    EXPECT_TRUE(cfg.adaptive_dt);
+    EXPECT_DOUBLE_EQ(cfg.cfl, 0.5);
+    EXPECT_EQ(cfg.dt_every, 4);
+    EXPECT_THROW({ merged_config(std::nullopt, {"--time.cfl=1.5"}); }, std::runtime_error);
+    EXPECT_THROW({ merged_config(std::nullopt, {"--time.dt_every=0"}); }, std::runtime_error);
+}
+
+TEST(Unit_IO_CLI, TracerFlags) {
+    SimConfig def = merged_config(std::nullopt, {});
+    EXPECT_EQ(def.tracers.count, 1);
+    EXPECT_EQ(def.tracers.layout, TracerLayout::Planes);
+
+    SimConfig cfg = merged_config(std::nullopt, {"--tracers.count", "4", "--tracers.layout=aos"});
+    EXPECT_EQ(cfg.tracers.count, 4);
+    EXPECT_EQ(cfg.tracers.layout, TracerLayout::Interleaved);
+    EXPECT_EQ(tracer_var_name(0), "u");
+    EXPECT_EQ(tracer_var_name(2), "u_2");
+    EXPECT_THROW({ merged_config(std::nullopt, {"--tracers.count=0"}); }, std::runtime_error);
+    EXPECT_THROW({ merged_config(std::nullopt, {"--tracers.layout=zigzag"}); }, std::runtime_error);
+    EXPECT_THROW(
+        { merged_config(std::nullopt, {"--tracers.count=2", "--time.scheme=implicit"}); },
+        std::runtime_error);
+}
+
 TEST(Unit_IO_File, WriteNetCDFAndReadBack) {
     int argc = 0;
     char** argv = nullptr;
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <mpi.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "decomp.hpp"
+#include "field.hpp"
+#include "io.hpp"
+#include "profile.hpp"
+#include "stepper.hpp"
+
+TEST(Unit_Profile, ScopedPhaseAccumulates) {
+    PhaseTimes t;
+    for (int i = 0; i < 3; ++i) {
+        ScopedPhase p(t, Phase::Swap);
+    }
+    EXPECT_EQ(t.calls[static_cast<int>(Phase::Swap)], 3);
+    EXPECT_GE(t[Phase::Swap], 0.0);
+    EXPECT_EQ(t.calls[static_cast<int>(Phase::Output)], 0);
+
+    PhaseTimes sum;
+    sum.add(Phase::Output, 1.5);
+    sum += t;
+    sum += t;
+    EXPECT_EQ(sum.calls[static_cast<int>(Phase::Swap)], 6);
+    EXPECT_DOUBLE_EQ(sum[Phase::Output], 1.5);
+}
+
+TEST(Unit_Profile, ReduceAcrossRanks) {
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    PhaseTimes t;
+    t.add(Phase::HaloWait, rank + 1.0);  // 1, 2, ..., size seconds
+    for (int i = 0; i <= rank; ++i) t.add(Phase::Output, 0.0);
+
+    const auto stats = reduce_phase_times(t, MPI_COMM_WORLD);
+    ASSERT_EQ(static_cast<int>(stats.size()), kPhaseCount);
+    const PhaseStats& w = stats[static_cast<int>(Phase::HaloWait)];
+    EXPECT_EQ(w.phase, Phase::HaloWait);
+    EXPECT_DOUBLE_EQ(w.min, 1.0);
+    EXPECT_DOUBLE_EQ(w.max, size);
+    EXPECT_DOUBLE_EQ(w.mean, (size + 1) / 2.0);
+    EXPECT_DOUBLE_EQ(w.imbalance, size / ((size + 1) / 2.0) - 1.0);
+    EXPECT_EQ(stats[static_cast<int>(Phase::Output)].calls, size);
+
+    const PhaseStats& idle = stats[static_cast<int>(Phase::Boundary)];
+    EXPECT_EQ(idle.calls, 0);
+    EXPECT_DOUBLE_EQ(idle.imbalance, 0.0);
+}
+
+TEST(Unit_Profile, StepperTimesEveryPhase) {
+    SimConfig cfg;
+    cfg.nx = 24;
+    cfg.ny = 20;
+    cfg.D = 0.1;
+    cfg.vx = 0.3;
+    cfg.dt = 0.5;
+    Decomp2D dec;
+    dec.init(MPI_COMM_WORLD, cfg.nx, cfg.ny);
+    Stepper stepper(cfg, dec, MPI_COMM_WORLD);
+    Field u(dec.nx_local, dec.ny_local, 1, cfg.dx, cfg.dy);
+    Field tmp(dec.nx_local, dec.ny_local, 1, cfg.dx, cfg.dy);
+    u.fill(1.0);
+    tmp.fill(0.0);
+    for (int n = 0; n < 4; ++n) stepper.step(u, tmp);
+
+    const PhaseTimes& t = stepper.timings().phases;
+    for (Phase p : {Phase::HaloPost, Phase::HaloWait, Phase::KernelInterior, Phase::Boundary,
+                    Phase::KernelEdges, Phase::Swap})
+        EXPECT_EQ(t.calls[static_cast<int>(p)], 4) << phase_to_string(p);
+    EXPECT_EQ(t.calls[static_cast<int>(Phase::KernelSplit)], 0);
+    dec.finalize();
+}
+
+TEST(Unit_Profile, ReportFormats) {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    PhaseReport r;
+    r.ranks = 4;
+    r.nx = r.ny = 1000;
+    r.steps = 10;
+    r.loop_seconds = 2.0;
+    r.compute_seconds = 1.0;
+    PhaseTimes t;
+    t.add(Phase::KernelEdges, 0.25);
+    r.phases = reduce_phase_times(t, MPI_COMM_WORLD);
+    EXPECT_DOUBLE_EQ(r.mlups(), 5.0);
+    EXPECT_DOUBLE_EQ(r.compute_mlups(), 10.0);
+    EXPECT_DOUBLE_EQ(mlups(1e6, 0.0), 0.0);
+
+    auto slurp = [](const std::string& path) {
+        std::ifstream is(path);
+        std::stringstream ss;
+        ss << is.rdbuf();
+        return ss.str();
+    };
+    const std::string base = "tmp_phase_report_" + std::to_string(rank);
+
+    write_phase_report(base + ".json", r);
+    const std::string json = slurp(base + ".json");
+    EXPECT_NE(json.find("\"mlups\": 5,"), std::string::npos);
+    EXPECT_NE(json.find("{\"phase\": \"kernel_edges\", \"calls\": 1, \"min_s\": 0.25"),
+              std::string::npos);
+
+    write_phase_report(base + ".csv", r);
+    const std::string csv = slurp(base + ".csv");
+    EXPECT_NE(csv.find("phase,calls,min_s,mean_s,max_s,imbalance\n"), std::string::npos);
+    EXPECT_NE(csv.find("\nkernel_edges,1,0.25,0.25,0.25,0\n"), std::string::npos);
+
+    std::remove((base + ".json").c_str());
+    std::remove((base + ".csv").c_str());
+    EXPECT_THROW(write_phase_report("no_such_dir/report.json", r), std::runtime_error);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    const int rc = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return rc;
+}
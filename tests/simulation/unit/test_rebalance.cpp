@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <mpi.h>
+
+#include <vector>
+
+#include "decomp.hpp"
+#include "field.hpp"
+#include "io.hpp"
+#include "rebalance.hpp"
+#include "stepper.hpp"
+
+namespace {
+
+double global_value(int gx, int gy, int k) { return gx + 100.0 * gy + 10000.0 * k; }
+
+template <typename T>
+void fill_global(FieldT<T>& f, const Decomp2D& d) {
+    for (int k = 0; k < f.tracers(); ++k)
+        for (int j = 0; j < d.ny_local; ++j)
+            for (int i = 0; i < d.nx_local; ++i)
+                f.at(i + f.halo, j + f.halo, k) =
+                    static_cast<T>(global_value(i + d.x_offset, j + d.y_offset, k));
+}
+
+template <typename T>
+int count_mismatches(const FieldT<T>& f, const Decomp2D& d) {
+    int bad = 0;
+    for (int k = 0; k < f.tracers(); ++k)
+        for (int j = 0; j < d.ny_local; ++j)
+            for (int i = 0; i < d.nx_local; ++i)
+                if (f.at(i + f.halo, j + f.halo, k) !=
+                    static_cast<T>(global_value(i + d.x_offset, j + d.y_offset, k)))
+                    ++bad;
+    return bad;
+}
+
+}  // namespace
+
+TEST(Unit_Rebalance, ImbalanceIsMaxOverMean) {
+    EXPECT_DOUBLE_EQ(load_imbalance({1.0, 1.0, 1.0}), 0.0);
+    EXPECT_DOUBLE_EQ(load_imbalance({1.0, 3.0}), 0.5);
+    EXPECT_DOUBLE_EQ(load_imbalance({}), 0.0);
+}
+
+TEST(Unit_Rebalance, CutsSplitCostEvenly) {
+    EXPECT_EQ(balance_cuts({0, 10, 20, 30}, {1, 1, 1}, 1), (std::vector<int>{0, 10, 20, 30}));
+    // Last slab four times as costly per cell: each new slab gets a third of the total cost.
+    EXPECT_EQ(balance_cuts({0, 10, 20, 30}, {1, 1, 4}, 1), (std::vector<int>{0, 20, 25, 30}));
+}
+
+TEST(Unit_Rebalance, CutsStayWithinNeighbors) {
+    const std::vector<int> old{0, 10, 20, 30, 40};
+    const std::vector<int> cuts = balance_cuts(old, {100, 1, 1, 1}, 2);
+    ASSERT_EQ(cuts.size(), old.size());
+    EXPECT_EQ(cuts.front(), 0);
+    EXPECT_EQ(cuts.back(), 40);
+    for (size_t k = 1; k + 1 < cuts.size(); ++k) {
+        EXPECT_GE(cuts[k], old[k - 1]);
+        EXPECT_LE(cuts[k], old[k + 1]);
+        EXPECT_GE(cuts[k] - cuts[k - 1], 2);
+    }
+    EXPECT_LT(cuts[1], old[1]);  // the costly slab shrinks
+}
+
+TEST(Unit_Rebalance, PredictedCostsSpreadUniformly) {
+    // 2 x 1 tiles of 10 columns; the left one costs 3, the right one 1.
+    const std::vector<double> pred = predicted_costs({3.0, 1.0}, {0, 10, 20}, {0, 5}, {0, 5, 20},
+                                                     {0, 5});
+    ASSERT_EQ(pred.size(), 2u);
+    EXPECT_DOUBLE_EQ(pred[0], 1.5);
+    EXPECT_DOUBLE_EQ(pred[1], 2.5);
+}
+
+TEST(Unit_Rebalance, MigrationKeepsGlobalField) {
+    for (TracerLayout layout : {TracerLayout::Planes, TracerLayout::Interleaved}) {
+        Decomp2D d;
+        d.init(MPI_COMM_WORLD, 24, 20);
+        const Tracers tr{2, layout};
+        Field src(d.nx_local, d.ny_local, 1, 1.0, 1.0, tr);
+        src.fill(0.0);
+        fill_global(src, d);
+
+        std::vector<double> xcost(d.dims[0]), ycost(d.dims[1]);
+        for (int i = 0; i < d.dims[0]; ++i) xcost[i] = i + 1.0;
+        for (int j = 0; j < d.dims[1]; ++j) ycost[j] = d.dims[1] - j;
+        const std::vector<int> old_x = d.x_cuts, old_y = d.y_cuts;
+        d.set_cuts(balance_cuts(old_x, xcost, 1), balance_cuts(old_y, ycost, 1));
+
+        Field dst(d.nx_local, d.ny_local, 1, 1.0, 1.0, tr);
+        dst.fill(0.0);
+        const long long received = migrate_field(src, dst, d, old_x, old_y);
+        EXPECT_EQ(count_mismatches(dst, d), 0);
+        EXPECT_GE(received, 0);
+        d.finalize();
+    }
+}
+
+TEST(Unit_Rebalance, BalancerShrinksSlowTiles) {
+    SimConfig cfg;
+    cfg.decomp.rebalance_every = 10;
+    LoadBalancer lb(cfg);
+    EXPECT_TRUE(lb.enabled());
+    EXPECT_FALSE(lb.due(0));
+    EXPECT_TRUE(lb.due(20));
+    EXPECT_FALSE(lb.due(25));
+
+    Decomp2D d;
+    d.init(MPI_COMM_WORLD, 32, 32);
+    FieldF u(d.nx_local, d.ny_local, 1, 1.0, 1.0), tmp(d.nx_local, d.ny_local, 1, 1.0, 1.0);
+    u.fill(0.0f);
+    fill_global(u, d);
+
+    // Cells in the first process column cost three times as much.
+    const int nx_before = d.nx_local;
+    const double busy = d.nx_local * d.ny_local * (d.coords[0] == 0 ? 3.0 : 1.0);
+    const RebalanceStats st = lb.rebalance(d, 10, busy, u, tmp);
+    EXPECT_EQ(st.step, 10);
+    if (d.dims[0] == 1) {
+        EXPECT_FALSE(st.moved);
+        EXPECT_DOUBLE_EQ(st.imbalance_before, 0.0);
+    } else {
+        EXPECT_TRUE(st.moved);
+        EXPECT_LT(st.imbalance_after, st.imbalance_before);
+        EXPECT_GT(st.cells_moved, 0);
+        if (d.coords[0] == 0) {
+            EXPECT_LT(d.nx_local, nx_before);
+        }
+    }
+    EXPECT_EQ(u.nx_local, d.nx_local);
+    EXPECT_EQ(tmp.nx_local, d.nx_local);
+    EXPECT_EQ(tmp.ny_local, d.ny_local);
+    EXPECT_EQ(count_mismatches(u, d), 0);
+    d.finalize();
+}
+
+TEST(Unit_Rebalance, SteppingAcrossRebalanceMatchesStaticTiles) {
+    SimConfig cfg;
+    cfg.nx = 40;
+    cfg.ny = 28;
+    cfg.D = 0.1;
+    cfg.vx = 0.4;
+    cfg.vy = -0.3;
+    cfg.dt = 0.5;
+    cfg.bc.left = cfg.bc.right = BCType::Neumann;
+
+    Decomp2D ref;
+    ref.init(MPI_COMM_WORLD, cfg.nx, cfg.ny);
+    Stepper a(cfg, ref, MPI_COMM_WORLD);
+    Field ua(ref.nx_local, ref.ny_local, 1, 1.0, 1.0);
+    Field ta(ref.nx_local, ref.ny_local, 1, 1.0, 1.0);
+    ua.fill(0.0);
+    ta.fill(0.0);
+    fill_global(ua, ref);
+    for (int n = 0; n < 20; ++n) a.step(ua, ta);
+
+    Decomp2D d;
+    d.init(MPI_COMM_WORLD, cfg.nx, cfg.ny);
+    Stepper b(cfg, d, MPI_COMM_WORLD);
+    Field ub(d.nx_local, d.ny_local, 1, 1.0, 1.0), tb(d.nx_local, d.ny_local, 1, 1.0, 1.0);
+    ub.fill(0.0);
+    tb.fill(0.0);
+    fill_global(ub, d);
+    for (int n = 0; n < 10; ++n) b.step(ub, tb);
+
+    std::vector<double> xcost(d.dims[0], 1.0), ycost(d.dims[1], 1.0);
+    xcost[0] = ycost[0] = 4.0;
+    const std::vector<int> static_x = d.x_cuts, static_y = d.y_cuts;
+    d.set_cuts(balance_cuts(static_x, xcost, 1), balance_cuts(static_y, ycost, 1));
+    Field moved(d.nx_local, d.ny_local, 1, 1.0, 1.0);
+    moved.fill(0.0);
+    migrate_field(ub, moved, d, static_x, static_y);
+    ub = std::move(moved);
+    tb = Field(d.nx_local, d.ny_local, 1, 1.0, 1.0);
+    tb.fill(0.0);
+    b.reset_decomposition();
+    for (int n = 0; n < 10; ++n) b.step(ub, tb);
+
+    // Back to the static tiles for the comparison.
+    const std::vector<int> moved_x = d.x_cuts, moved_y = d.y_cuts;
+    d.set_cuts(static_x, static_y);
+    Field back(d.nx_local, d.ny_local, 1, 1.0, 1.0);
+    back.fill(0.0);
+    migrate_field(ub, back, d, moved_x, moved_y);
+    for (int j = 0; j < d.ny_local; ++j)
+        for (int i = 0; i < d.nx_local; ++i)
+            ASSERT_DOUBLE_EQ(back.at(i + 1, j + 1), ua.at(i + 1, j + 1)) << i << "," << j;
+
+    d.finalize();
+    ref.finalize();
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    const int rc = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return rc;
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <mpi.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "io.hpp"
+#include "profile.hpp"
+#include "report.hpp"
+
+TEST(Unit_Report, PeakRssIsReported) {
+#ifdef __linux__
+    EXPECT_GT(peak_rss_kb(), 0);
+#else
+    EXPECT_GE(peak_rss_kb(), -1);
+#endif
+}
+
+TEST(Unit_Report, GatherOrdersByRank) {
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    RankStats local;
+    local.rank = rank;
+    local.nx_local = 10 + rank;
+    local.halo_bytes_per_step = 100.0 * rank;
+    const auto all = gather_rank_stats(local, MPI_COMM_WORLD);
+    if (rank != 0) {
+        EXPECT_TRUE(all.empty());
+        return;
+    }
+    ASSERT_EQ(static_cast<int>(all.size()), size);
+    for (int r = 0; r < size; ++r) {
+        EXPECT_EQ(all[r].rank, r);
+        EXPECT_EQ(all[r].nx_local, 10 + r);
+        EXPECT_DOUBLE_EQ(all[r].halo_bytes_per_step, 100.0 * r);
+    }
+}
+
+TEST(Unit_Report, JsonCarriesConfigAndTotals) {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    RunReport r;
+    r.cfg.dt = 0.25;
+    r.cfg.report = "json";
+    r.cfg.ic.path = "a\"b.nc";
+    r.dt_requested = 1.0;
+    r.dims[0] = 2;
+    r.steps = 10;
+    r.ranks.resize(2);
+    r.ranks[0].halo_bytes_per_step = 1000.0;
+    r.ranks[1].halo_bytes_per_step = 3000.0;
+    r.ranks[0].halo_on_node_bytes_per_step = 1000.0;
+    r.ranks[1].halo_on_node_bytes_per_step = 1500.0;
+    r.ranks[0].peak_rss_kb = 10;
+    r.ranks[1].peak_rss_kb = 20;
+    r.output_bytes = 4e6;
+    r.output_seconds = 2.0;
+
+    const std::string path = "tmp_run_report_" + std::to_string(rank) + ".json";
+    write_run_report(path, r);
+    std::ifstream is(path);
+    std::stringstream ss;
+    ss << is.rdbuf();
+    const std::string json = ss.str();
+    std::remove(path.c_str());
+
+    EXPECT_NE(json.find("\"dt\": 0.25, \"dt_requested\": 1, \"dt_clamped\": true"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"path\": \"a\\\"b.nc\""), std::string::npos);
+    EXPECT_NE(json.find("\"dims\": [2, 1]"), std::string::npos);
+    EXPECT_NE(json.find("\"bandwidth_mbs\": 2}"), std::string::npos);
+    EXPECT_NE(json.find("\"bytes_per_step\": 4000, \"max_rank_bytes_per_step\": 3000"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"intra_node_bytes_per_step\": 2500, \"inter_node_bytes_per_step\": 1500"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"peak_rss_kb_max\": 20, \"peak_rss_kb_total\": 30"), std::string::npos);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    const int rc = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return rc;
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "advect_diffuse.hpp"
+#include "advection.hpp"
+#include "diffusion.hpp"
+#include "field.hpp"
+#include "simd.hpp"
+
+static std::vector<SimdLevel> supported_levels() {
+    std::vector<SimdLevel> out;
+    for (SimdLevel l : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512})
+        if (l <= detect_simd_level())
+            out.push_back(l);
+    return out;
+}
+
+static std::vector<double> pattern(size_t n, double scale) {
+    std::vector<double> v(n);
+    for (size_t k = 0; k < n; ++k) v[k] = scale * static_cast<double>((k * 37) % 11) - 0.3;
+    return v;
+}
+
+TEST(Unit_Simd, ParseAndResolve) {
+    EXPECT_EQ(simd_from_string("AVX2"), SimdLevel::AVX2);
+    EXPECT_EQ(simd_to_string(SimdLevel::AVX512), "avx512");
+    EXPECT_EQ(resolve_simd_level("auto"), detect_simd_level());
+    EXPECT_EQ(resolve_simd_level("scalar"), SimdLevel::Scalar);
+    EXPECT_LE(resolve_simd_level("avx512"), detect_simd_level());
+    EXPECT_THROW(simd_from_string("neon9000"), std::runtime_error);
+}
+
+// Every row length 1..19 at every start offset 1..8 covers all vector remainders and alignments.
+TEST(Unit_Simd, RowKernelsMatchScalarForRemaindersAndOffsets) {
+    const RowKernels& ref = row_kernels(SimdLevel::Scalar);
+    const int width = 40;
+    const auto s = pattern(width, 0.5), c = pattern(width + 3, 1.25), n = pattern(width, -0.75);
+
+    for (SimdLevel level : supported_levels()) {
+        const RowKernels& k = row_kernels(level);
+        for (int off = 1; off <= 8; ++off) {
+            for (int count = 1; count < 20; ++count) {
+                std::vector<double> a(width, 0.0), b(width, 0.0);
+                ref.diffuse(&s[off], &c[off], &n[off], &a[off], count, 0.1, 0.2);
+                k.diffuse(&s[off], &c[off], &n[off], &b[off], count, 0.1, 0.2);
+                EXPECT_EQ(a, b) << simd_to_string(level) << " diffuse off=" << off;
+
+                ref.advect(&c[off - 1], &c[off], &s[off], &c[off], &a[off], count, 0.3, -0.4);
+                k.advect(&c[off - 1], &c[off], &s[off], &c[off], &b[off], count, 0.3, -0.4);
+                EXPECT_EQ(a, b) << simd_to_string(level) << " advect off=" << off;
+
+                for (int ox : {0, 1}) {
+                    const double* sp = &s[off];
+                    const double* cp = &c[off];
+                    const double* np = &n[off];
+                    ref.advect_diffuse(sp, cp, np, cp, np, ox, &a[off], count, 0.1, 0.2, 0.3, 0.4);
+                    k.advect_diffuse(sp, cp, np, cp, np, ox, &b[off], count, 0.1, 0.2, 0.3, 0.4);
+                    EXPECT_EQ(a, b) << simd_to_string(level) << " fused off=" << off;
+                }
+            }
+        }
+    }
+}
+
+TEST(Unit_Simd, FieldKernelsIndependentOfLevel) {
+    const SimdLevel saved = active_simd_level();
+    Field u(13, 6, 2, 1.0, 0.5);
+    const std::vector<double> p = pattern(u.data.size(), 0.9);
+    u.data.assign(p.begin(), p.end());
+
+    set_simd_level(SimdLevel::Scalar);
+    Field ref(13, 6, 2, 1.0, 0.5);
+    ref.data = u.data;
+    diffusion_step(u, ref, 0.2, 0.05);
+    advection_step(u, ref, -0.6, 0.8, 0.05);
+    Field ref_fused(13, 6, 2, 1.0, 0.5);
+    advect_diffuse_step(u, ref_fused, 0.2, -0.6, 0.8, 0.05);
+
+    for (SimdLevel level : supported_levels()) {
+        set_simd_level(level);
+        Field out(13, 6, 2, 1.0, 0.5);
+        out.data = u.data;
+        diffusion_step(u, out, 0.2, 0.05);
+        advection_step(u, out, -0.6, 0.8, 0.05);
+        EXPECT_EQ(out.data, ref.data) << simd_to_string(level);
+
+        Field fused(13, 6, 2, 1.0, 0.5);
+        advect_diffuse_step(u, fused, 0.2, -0.6, 0.8, 0.05);
+        EXPECT_EQ(fused.data, ref_fused.data) << simd_to_string(level);
+    }
+    set_simd_level(saved);
+}
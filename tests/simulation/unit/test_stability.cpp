@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "stability.hpp"
 
 TEST(Unit_Stability, ReturnsPositiveLimit) {
@@ -25,3 +29,22 @@ TEST(Unit_Stability, LowerWithHigherDiffusion) {
     double high_D = safe_dt(dx, dy, vx, vy, 1.0);
     EXPECT_LT(high_D, low_D);
 }
+
+TEST(Unit_Stability, SafeDtIsTheSmallerTermLimit) {
+    const double adv = advective_dt(1.0, 2.0, 0.5, -1.0);
+    const double diff = diffusive_dt(1.0, 2.0, 0.3);
+    EXPECT_DOUBLE_EQ(adv, 1.0);
+    EXPECT_DOUBLE_EQ(diff, 1.0 / (2.0 * 0.3 * 1.25));
+    EXPECT_DOUBLE_EQ(safe_dt(1.0, 2.0, 0.5, -1.0, 0.3), std::min(adv, diff));
+    EXPECT_TRUE(std::isinf(advective_dt(1.0, 1.0, 0.0, 0.0)));
+    EXPECT_TRUE(std::isinf(diffusive_dt(1.0, 1.0, 0.0)));
+}
+
+TEST(Unit_Stability, SubstepCount) {
+    EXPECT_EQ(substep_count(0.5, 1.0), 1);
+    EXPECT_EQ(substep_count(1.0, 1.0), 1);
+    EXPECT_EQ(substep_count(3.0, 1.0), 3);
+    EXPECT_EQ(substep_count(0.3, 0.1), 3);  // 0.3 / 0.1 rounds to just below 3
+    EXPECT_EQ(substep_count(3.01, 1.0), 4);
+    EXPECT_EQ(substep_count(5.0, std::numeric_limits<double>::infinity()), 1);
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include <mpi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "allocator.hpp"
+#include "decomp.hpp"
+#include "field.hpp"
+#include "io.hpp"
+#include "stability.hpp"
+#include "stepper.hpp"
+#include "stepper_helpers.hpp"
+#include "subcycle.hpp"
+
+static SimConfig make_config(int halo_depth, bool fused, bool overlap = true) {
+    SimConfig cfg = mixed_bc_config(30, 26, 0.15, 0.2);
+    cfg.vx = 0.6;
+    cfg.vy = -0.35;
+    cfg.perf.fused = fused;
+    cfg.perf.halo_depth = halo_depth;
+    cfg.perf.overlap = overlap;
+    return cfg;
+}
+
+// Tracer k starts from initial pattern `pattern + k`.
+template <typename T = double, typename Acc = T>
+static std::vector<double> run(const SimConfig& cfg, int steps, int pattern = 0) {
+    return run_stepper<T, Acc>(cfg, steps, [pattern](int gi, int gj, int k) {
+        return std::sin(0.3 * gi + 0.5 * (pattern + k)) * std::cos(0.2 * gj) + 0.01 * gi;
+    });
+}
+
+static void expect_depth_invariant(bool fused) {
+    const int steps = 7;
+    const std::vector<double> ref = run(make_config(1, fused), steps);
+    for (int depth : {2, 3}) {
+        const std::vector<double> deep = run(make_config(depth, fused), steps);
+        ASSERT_EQ(deep.size(), ref.size());
+        for (size_t k = 0; k < ref.size(); ++k)
+            ASSERT_EQ(deep[k], ref[k]) << "depth " << depth << " cell " << k;
+    }
+}
+
+TEST(Unit_Stepper, DeepHaloMatchesSingleLayerSplit) { expect_depth_invariant(false); }
+
+TEST(Unit_Stepper, DeepHaloMatchesSingleLayerFused) { expect_depth_invariant(true); }
+
+TEST(Unit_Stepper, OverlapMatchesBlockingExchange) {
+    const int steps = 5;
+    for (int depth : {1, 2}) {
+        const std::vector<double> ref = run(make_config(depth, false, false), steps);
+        const std::vector<double> ovl = run(make_config(depth, false, true), steps);
+        ASSERT_EQ(ovl.size(), ref.size());
+        for (size_t k = 0; k < ref.size(); ++k)
+            ASSERT_EQ(ovl[k], ref[k]) << "depth " << depth << " cell " << k;
+    }
+}
+
+TEST(Unit_Stepper, PaddedLayoutMatchesDefault) {
+    const int steps = 5;
+    const std::vector<double> ref = run(make_config(2, true), steps);
+    const FieldLayout saved = field_layout();
+    set_field_layout(FieldLayout{true, true});
+    const std::vector<double> padded = run(make_config(2, true), steps);
+    set_field_layout(saved);
+    EXPECT_EQ(padded, ref);
+}
+
+// A batched run is the separate single-tracer runs side by side, for both layouts, both kernel
+// paths and temporal blocking.
+TEST(Unit_Stepper, TracerBatchMatchesSeparateRuns) {
+    const int steps = 5;
+    const int ntracers = 3;
+    for (bool fused : {false, true}) {
+        for (int depth : {1, 2}) {
+            std::vector<double> ref;
+            for (int k = 0; k < ntracers; ++k) {
+                const std::vector<double> one = run(make_config(depth, fused), steps, k);
+                ref.insert(ref.end(), one.begin(), one.end());
+            }
+            for (TracerLayout layout : {TracerLayout::Planes, TracerLayout::Interleaved}) {
+                SimConfig cfg = make_config(depth, fused);
+                cfg.tracers = Tracers{ntracers, layout};
+                EXPECT_EQ(run(cfg, steps), ref)
+                    << "fused " << fused << " depth " << depth << " layout "
+                    << tracer_layout_to_string(layout);
+            }
+        }
+    }
+}
+
+// Float and mixed runs stay within single-precision rounding of the double run.
+TEST(Unit_Stepper, PrecisionModesTrackDouble) {
+    const int steps = 20;
+    const SimConfig cfg = make_config(2, true);
+    const std::vector<double> ref = run<double>(cfg, steps);
+    const std::vector<double> f32 = run<float, float>(cfg, steps);
+    const std::vector<double> mix = run<float, double>(cfg, steps);
+    ASSERT_EQ(f32.size(), ref.size());
+    ASSERT_EQ(mix.size(), ref.size());
+
+    double err_f32 = 0.0, err_mix = 0.0;
+    for (size_t k = 0; k < ref.size(); ++k) {
+        err_f32 = std::max(err_f32, std::abs(f32[k] - ref[k]));
+        err_mix = std::max(err_mix, std::abs(mix[k] - ref[k]));
+    }
+    EXPECT_LT(err_f32, 1e-5);
+    EXPECT_LT(err_mix, 1e-5);
+}
+
+// Backward Euler with advection split off and the explicit scheme are both first order in time:
+// their difference at a fixed end time halves with dt.
+TEST(Unit_Stepper, ImplicitConvergesToExplicit) {
+    double err[2] = {0.0, 0.0};
+    for (int refine = 0; refine < 2; ++refine) {
+        SimConfig cfg = make_config(1, true);
+        cfg.dt /= 1 << refine;
+        const int steps = 20 << refine;
+        const std::vector<double> ref = run(cfg, steps);
+        cfg.scheme = TimeScheme::Implicit;
+        cfg.cg_tol = 1e-12;
+        const std::vector<double> imp = run(cfg, steps);
+        ASSERT_EQ(imp.size(), ref.size());
+        for (size_t k = 0; k < ref.size(); ++k)
+            err[refine] = std::max(err[refine], std::abs(imp[k] - ref[k]));
+    }
+    EXPECT_LT(err[0], 1e-2);
+    EXPECT_GT(err[0] / err[1], 1.8);
+    EXPECT_LT(err[0] / err[1], 2.2);
+}
+
+// Subcycling either term stays close to a fine explicit reference at outer steps above the stiff
+// term's limit. With diffusion stiff the splitting error is first order in the outer dt; upwind
+// error depends on the Courant number rather than dt alone, so the advection case only checks
+// the magnitude.
+TEST(Unit_Stepper, SubcycleConvergesToExplicit) {
+    for (double D : {0.15, 2.0}) {
+        SimConfig base = make_config(1, true);
+        base.D = D;
+        const double t_end = 3.2;
+        SimConfig fine = base;
+        fine.dt = 0.4 * safe_dt(base.dx, base.dy, base.vx, base.vy, base.D);
+        const int fine_steps = static_cast<int>(std::round(t_end / fine.dt));
+        fine.dt = t_end / fine_steps;
+        const std::vector<double> ref = run(fine, fine_steps);
+
+        // Outer steps just under the looser limit, so the stiff term needs substeps.
+        const double loose = std::max(advective_dt(base.dx, base.dy, base.vx, base.vy),
+                                      diffusive_dt(base.dx, base.dy, base.D));
+        const int outer = static_cast<int>(std::ceil(t_end / (0.95 * loose)));
+
+        double err[2] = {0.0, 0.0};
+        for (int refine = 0; refine < 2; ++refine) {
+            SimConfig cfg = base;
+            cfg.scheme = TimeScheme::Subcycle;
+            cfg.dt = t_end / (outer << refine);
+            const SubcycleSplit split = subcycle_split(cfg, cfg.dt);
+            EXPECT_EQ(split.stiff, D > 1.0 ? StiffTerm::Diffusion : StiffTerm::Advection);
+            if (refine == 0)
+                EXPECT_GT(split.substeps, 1) << "D=" << D;
+            const std::vector<double> sub = run(cfg, outer << refine);
+            ASSERT_EQ(sub.size(), ref.size());
+            for (size_t k = 0; k < ref.size(); ++k)
+                err[refine] = std::max(err[refine], std::abs(sub[k] - ref[k]));
+        }
+        EXPECT_LT(err[0], 0.1) << "D=" << D;
+        if (D > 1.0)
+            EXPECT_GT(err[0] / err[1], 1.5);
+    }
+}
+
+TEST(Unit_Stepper, RejectsHaloDeeperThanTile) {
+    SimConfig cfg = make_config(1, false);
+    Decomp2D dec;
+    dec.init(MPI_COMM_WORLD, cfg.nx, cfg.ny);
+    cfg.perf.halo_depth = dec.nx_local + 1;
+    EXPECT_THROW({ Stepper s(cfg, dec, MPI_COMM_WORLD); }, std::runtime_error);
+    dec.finalize();
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    const int rc = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return rc;
+}
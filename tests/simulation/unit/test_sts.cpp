@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <mpi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "decomp.hpp"
+#include "field.hpp"
+#include "io.hpp"
+#include "stability.hpp"
+#include "stepper_helpers.hpp"
+#include "sts.hpp"
+
+TEST(Unit_Sts, StageCountCoversRequestedDt) {
+    EXPECT_EQ(rkl2_stages(0.5, 1.0), 2);
+    EXPECT_EQ(rkl2_stages(1.0, 1.0), 2);
+    EXPECT_EQ(rkl2_stages(10.0, 1.0), 6);  // (36 + 6 - 2) / 4 = 10
+    EXPECT_EQ(rkl2_stages(10.5, 1.0), 7);
+    for (double ratio : {1.7, 25.0, 400.0}) {
+        const int s = rkl2_stages(ratio, 1.0);
+        EXPECT_GE((s * s + s - 2) / 4.0, ratio);
+        EXPECT_LT(((s - 1) * (s - 1) + (s - 1) - 2) / 4.0, ratio);
+    }
+}
+
+static SimConfig make_config(TimeScheme scheme, double dt) {
+    SimConfig cfg = mixed_bc_config(36, 30, 0.5, dt);
+    cfg.scheme = scheme;
+    return cfg;
+}
+
+// Runs `steps` steps from a smooth bump and returns the local interior, row-major.
+static std::vector<double> run(const SimConfig& cfg, int steps) {
+    return run_stepper(cfg, steps, [](int gi, int gj, int) {
+        const double x = gi - 18.0, y = gj - 15.0;
+        return std::exp(-(x * x + y * y) / 30.0);
+    });
+}
+
+// RKL2 steps of 10x the explicit limit stay close to forward Euler at a small fraction of that
+// dt, and self-convergence under halving dt is second order.
+TEST(Unit_Sts, Rkl2IsSecondOrderFarAboveLimit) {
+    const double limit = safe_dt(1.0, 1.0, 0.0, 0.0, 0.5);
+    const double big = 10.0 * limit;
+    std::vector<double> sts[3];
+    for (int refine = 0; refine < 3; ++refine)
+        sts[refine] = run(make_config(TimeScheme::Rkl2, big / (1 << refine)), 4 << refine);
+    const std::vector<double> ref = run(make_config(TimeScheme::Explicit, big / 40.0), 40 * 4);
+
+    double diff[2] = {0.0, 0.0}, err = 0.0;
+    for (size_t k = 0; k < ref.size(); ++k) {
+        diff[0] = std::max(diff[0], std::abs(sts[0][k] - sts[1][k]));
+        diff[1] = std::max(diff[1], std::abs(sts[1][k] - sts[2][k]));
+        err = std::max(err, std::abs(sts[0][k] - ref[k]));
+    }
+    EXPECT_LT(err, 5e-3);
+    EXPECT_GT(diff[0] / diff[1], 3.0);
+}
+
+// A single tracer stored interleaved has the same values as the default layout, so RKL2 must
+// give the same result for it.
+TEST(Unit_Sts, Rkl2AcceptsInterleavedLayout) {
+    SimConfig cfg = make_config(TimeScheme::Rkl2, 10.0 * safe_dt(1.0, 1.0, 0.0, 0.0, 0.5));
+    const std::vector<double> ref = run(cfg, 3);
+    cfg.tracers.layout = TracerLayout::Interleaved;
+    EXPECT_EQ(run(cfg, 3), ref);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    const int rc = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return rc;
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "advect_diffuse.hpp"
+#include "advection.hpp"
+#include "diffusion.hpp"
+#include "field.hpp"
+#include "threads.hpp"
+#include "tiling.hpp"
+
+static Field make_field(int nx, int ny) {
+    Field f(nx, ny, 1, 1.0, 1.0);
+    for (size_t k = 0; k < f.data.size(); ++k) f.data[k] = static_cast<double>((k * 29) % 13);
+    return f;
+}
+
+TEST(Unit_Tiling, TilesCoverRectExactlyOnce) {
+    const Rect r{1, 18, 1, 12};
+    std::vector<int> hits(20 * 13, 0);
+    for_each_tile(r, TileShape{5, 4}, [&](const Rect& t) {
+        EXPECT_LE(t.i1 - t.i0, 5);
+        EXPECT_LE(t.j1 - t.j0, 4);
+        for (int j = t.j0; j < t.j1; ++j)
+            for (int i = t.i0; i < t.i1; ++i) hits[j * 20 + i]++;
+    });
+    for (int j = 0; j < 13; ++j)
+        for (int i = 0; i < 20; ++i) {
+            const bool inside = i >= r.i0 && i < r.i1 && j >= r.j0 && j < r.j1;
+            EXPECT_EQ(hits[j * 20 + i], inside ? 1 : 0);
+        }
+}
+
+TEST(Unit_Tiling, DefaultShapeFitsL2) {
+    const TileShape t = default_tile_shape(16384, 16384, sizeof(double));
+    EXPECT_GT(t.tx, 0);
+    EXPECT_GE(t.ty, 4);
+    if (t.ty > 4)
+        EXPECT_LE(static_cast<size_t>(t.tx) * t.ty * 2 * sizeof(double), l2_cache_bytes() / 2);
+
+    const TileShape small = resolve_tile_shape(0, 0, 8, 8, sizeof(double));
+    EXPECT_LE(small.tx, 8);
+    EXPECT_LE(small.ty, 8);
+
+    const TileShape forced = resolve_tile_shape(64, 16, 1000, 1000, sizeof(double));
+    EXPECT_EQ(forced.tx, 64);
+    EXPECT_EQ(forced.ty, 16);
+}
+
+// Float storage fits twice as many cells in the same L2 budget.
+TEST(Unit_Tiling, DefaultShapeScalesWithElementSize) {
+    const TileShape d = default_tile_shape(1024, 1 << 20, sizeof(double));
+    const TileShape f = default_tile_shape(1024, 1 << 20, sizeof(float));
+    EXPECT_EQ(f.tx, d.tx);
+    EXPECT_GE(f.ty, 2 * d.ty);
+}
+
+TEST(Unit_Tiling, BlockedKernelsMatchUnblocked) {
+    const TileShape saved = active_tile_shape();
+    Field u = make_field(37, 23);
+
+    set_tile_shape(TileShape{});
+    Field ref(37, 23, 1, 1.0, 1.0);
+    std::copy(u.data.begin(), u.data.end(), ref.data.begin());
+    diffusion_step(u, ref, 0.1, 0.2);
+    advection_step(u, ref, 0.4, -0.3, 0.2);
+    Field ref_fused(37, 23, 1, 1.0, 1.0);
+    advect_diffuse_step(u, ref_fused, 0.1, 0.4, -0.3, 0.2);
+
+    set_tile_shape(TileShape{8, 5});
+    Field blocked(37, 23, 1, 1.0, 1.0);
+    diffuse_advect_blocked_step(u, blocked, 0.1, 0.4, -0.3, 0.2);
+    EXPECT_EQ(blocked.data, ref.data);
+
+    Field fused(37, 23, 1, 1.0, 1.0);
+    advect_diffuse_step(u, fused, 0.1, 0.4, -0.3, 0.2);
+    EXPECT_EQ(fused.data, ref_fused.data);
+
+    set_tile_shape(saved);
+}
+
+TEST(Unit_Tiling, ThreadedTilesMatchSerial) {
+    const TileShape saved = active_tile_shape();
+    const int saved_threads = max_threads();
+    Field u = make_field(211, 97);  // above kMinParallelCells, odd sizes
+
+    set_tile_shape(TileShape{});
+    set_threads(1);
+    Field serial(211, 97, 1, 1.0, 1.0);
+    diffuse_advect_blocked_step(u, serial, 0.1, 0.4, -0.3, 0.2);
+
+    set_threads(4);
+    for (TileShape shape : {TileShape{}, TileShape{64, 7}}) {
+        set_tile_shape(shape);
+        Field threaded(211, 97, 1, 1.0, 1.0);
+        diffuse_advect_blocked_step(u, threaded, 0.1, 0.4, -0.3, 0.2);
+        EXPECT_EQ(threaded.data, serial.data) << "tile " << shape.tx << "x" << shape.ty;
+    }
+
+    set_threads(saved_threads);
+    set_tile_shape(saved);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <mpi.h>
+
+#include <cmath>
+#include <vector>
+
+#include "io.hpp"
+#include "stability.hpp"
+#include "timestep.hpp"
+
+static SimConfig make_config(bool adaptive) {
+    SimConfig cfg;
+    cfg.dx = cfg.dy = 1.0;
+    cfg.vx = 1.0;
+    cfg.vy = 0.5;
+    cfg.D = 0.1;
+    cfg.dt = 0.7;
+    cfg.steps = 10;
+    cfg.out_every = 3;
+    cfg.adaptive_dt = adaptive;
+    return cfg;
+}
+
+TEST(Unit_Timestep, LocalLimitFollowsScheme) {
+    SimConfig cfg = make_config(false);
+    EXPECT_DOUBLE_EQ(local_dt_limit(cfg), safe_dt(1.0, 1.0, 1.0, 0.5, 0.1));
+    cfg.scheme = TimeScheme::Implicit;
+    EXPECT_DOUBLE_EQ(local_dt_limit(cfg), 1.0 / 1.5);  // advection only
+    cfg.vx = cfg.vy = 0.0;
+    EXPECT_TRUE(std::isinf(local_dt_limit(cfg)));
+}
+
+TEST(Unit_Timestep, FixedModeCountsSteps) {
+    TimeController clock(make_config(false), MPI_COMM_WORLD);
+    std::vector<long> outputs;
+    while (!clock.done()) {
+        if (clock.output_due()) {
+            outputs.push_back(clock.steps_taken());
+            clock.output_written();
+        }
+        const double dt = clock.next_dt();
+        EXPECT_DOUBLE_EQ(dt, 0.7);
+        clock.advance(dt);
+    }
+    EXPECT_EQ(clock.steps_taken(), 10);
+    EXPECT_EQ(outputs, (std::vector<long>{0, 3, 6, 9}));
+    EXPECT_NEAR(clock.time(), 7.0, 1e-12);
+}
+
+TEST(Unit_Timestep, AdaptiveLandsOnOutputTimes) {
+    const SimConfig cfg = make_config(true);
+    const double limit = cfg.cfl * local_dt_limit(cfg);
+    TimeController clock(cfg, MPI_COMM_WORLD);
+    std::vector<double> outputs;
+    while (!clock.done()) {
+        if (clock.output_due()) {
+            outputs.push_back(clock.time());
+            clock.output_written();
+        }
+        const double dt = clock.next_dt();
+        EXPECT_GT(dt, 0.0);
+        EXPECT_LE(dt, limit * (1.0 + 1e-12));
+        clock.advance(dt);
+    }
+    ASSERT_EQ(outputs.size(), 4u);
+    for (size_t k = 0; k < outputs.size(); ++k) EXPECT_EQ(outputs[k], k * 3 * 0.7);
+    EXPECT_EQ(clock.time(), 10 * 0.7);
+    EXPECT_GT(clock.steps_taken(), 10);  // 0.7 is above the explicit limit
+    EXPECT_LE(clock.max_dt(), limit * (1.0 + 1e-12));
+}
+
+TEST(Unit_Timestep, UnboundedLimitStepsToNextOutput) {
+    SimConfig cfg = make_config(true);
+    cfg.vx = cfg.vy = 0.0;
+    cfg.scheme = TimeScheme::Implicit;
+    TimeController clock(cfg, MPI_COMM_WORLD);
+    while (!clock.done()) {
+        if (clock.output_due())
+            clock.output_written();
+        clock.advance(clock.next_dt());
+    }
+    EXPECT_EQ(clock.steps_taken(), 4);  // 0 -> 2.1 -> 4.2 -> 6.3 -> 7
+    EXPECT_EQ(clock.time(), 7.0);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    MPI_Init(&argc, &argv);
+    const int rc = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return rc;
+}